@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <print>
+
+// Frames run before measuring, so pools and caches are warmed up.
+constexpr uint32_t WARM_UP_FRAMES = 10;
+
+// Keeps the compiler from optimizing away the computation of p_value.
+template<typename T>
+inline void keep(const T& p_value) {
+    asm volatile("" : : "r"(&p_value) : "memory");
+}
+
+// Runs p_frame p_frames times after the warm up and prints the average time
+// of one frame. p_frame gets the frame number.
+inline void measure(const char* p_name, uint32_t p_frames, const std::function<void(uint32_t)>& p_frame) {
+    for (uint32_t frame = 0; frame < WARM_UP_FRAMES; frame++) {
+        p_frame(frame);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < p_frames; frame++) {
+        p_frame(WARM_UP_FRAMES + frame);
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::println("{:<48} {:>9.4f} ms per frame", p_name, elapsed.count() / p_frames);
+}
+
+// --- Benchmarks ---
+void bench_transforms();
+void bench_components();
+void bench_spatial_index();
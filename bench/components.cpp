@@ -0,0 +1,67 @@
+#include <bench.h>
+#include <core/component_pool.h>
+#include <core/node.h>
+#include <core/update_scheduler.h>
+
+#include <vector>
+
+constexpr uint32_t FRAMES = 1000;
+
+// Updated every frame, like an animation player.
+struct BenchTicker : public Component {
+    double time { 0.0 };
+
+    void update(double p_delta) override {
+        time += p_delta;
+    }
+};
+
+// Only drawn, like a mesh instance, so it never needs an update.
+struct BenchProp : public Component {
+    void draw(const Mat4& p_transform, DrawContext& p_context) const override {}
+};
+
+// The update from before the component pools: a walk of the tree calling the
+// virtual update of every component.
+static void update_tree(Node* p_node, double p_delta) {
+    if (!p_node->is_active()) return;
+    for (auto& component : p_node->components) {
+        component->update(p_delta);
+    }
+    for (auto& child : p_node->children) {
+        update_tree(child.get(), p_delta);
+    }
+}
+
+// 50k components on 25k nodes, one of each type per node, in groups of 100
+// nodes. The scheduler runs without a job system, so both paths update on
+// one thread.
+void bench_components() {
+    constexpr uint32_t GROUP_COUNT = 250;
+    constexpr uint32_t GROUP_SIZE = 100;
+    constexpr double DELTA = 1.0 / 60.0;
+
+    auto root = Node::create("scene");
+    for (uint32_t group = 0; group < GROUP_COUNT; group++) {
+        auto group_node = Node::create();
+        for (uint32_t index = 0; index < GROUP_SIZE; index++) {
+            auto node = Node::create();
+            node->add_component<BenchTicker>();
+            node->add_component<BenchProp>();
+            group_node->add_child(node);
+        }
+        root->add_child(group_node);
+    }
+
+    measure("50k components, tree walk", FRAMES, [&](uint32_t p_frame) {
+        update_tree(root.get(), DELTA);
+    });
+
+    UpdateScheduler scheduler;
+    measure("50k components, pools", FRAMES, [&](uint32_t p_frame) {
+        scheduler.run(DELTA);
+    });
+
+    // So the updates are not optimized away.
+    keep(ComponentPool<BenchTicker>::get().components.front()->time);
+}
@@ -0,0 +1,72 @@
+#include <prosper.h>
+#include <core/residency.h>
+#include <core/resource_manager.h>
+#include <core/task.h>
+#include <core/task_scheduler.h>
+#include <resources/texture.h>
+
+#include <chrono>
+#include <filesystem>
+#include <print>
+
+// Loads every texture in a directory one by one with the blocking loader, then
+// all at once through the coroutine path, and prints how long both took. Opens
+// the engine's window and device like a game would.
+
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+constexpr vk::Format FORMAT = vk::Format::eR8G8B8A8Srgb;
+
+// Drops the loaded texture into the residency cache, cleared after each run
+// so both load from disk.
+static void release(Ref<Resource<Texture>> p_texture) {
+    p_texture->reference();
+    p_texture->unreference();
+}
+
+static prosper::Task<void> load_and_release(std::string p_path) {
+    release(co_await ResourceManager::load_task<Texture>(p_path, FORMAT));
+}
+
+static prosper::Task<void> load_concurrently(const std::vector<std::string>& p_paths, Milliseconds& r_time, bool& r_done) {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<prosper::Task<void>> loads;
+    for (auto& path : p_paths) {
+        loads.push_back(load_and_release(path));
+    }
+    co_await prosper::when_all(std::move(loads));
+    r_time = std::chrono::steady_clock::now() - start;
+    r_done = true;
+}
+
+int main(int p_argc, char** p_argv) {
+    const std::string directory = p_argc > 1 ? p_argv[1] : "assets/textures";
+    std::vector<std::string> paths;
+    for (auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.is_regular_file()) {
+            paths.push_back(entry.path().string());
+        }
+    }
+    if (!prosper::initialize()) {
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto& path : paths) {
+        release(ResourceManager::load<Texture>(path.c_str(), FORMAT));
+    }
+    const Milliseconds sequential = std::chrono::steady_clock::now() - start;
+    Residency::clear();
+
+    Milliseconds concurrent {};
+    bool done = false;
+    load_concurrently(paths, concurrent, done).start();
+    while (!done) {
+        prosper::TaskScheduler::poll();
+    }
+    Residency::clear();
+
+    std::println("Loaded {} textures: {:.1f} ms one by one, {:.1f} ms concurrently", paths.size(), sequential.count(), concurrent.count());
+    prosper::quit();
+    return 0;
+}
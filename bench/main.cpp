@@ -0,0 +1,9 @@
+#include <bench.h>
+
+// CPU side benchmarks of the scene systems, without a window or GPU.
+int main() {
+    bench_transforms();
+    bench_components();
+    bench_spatial_index();
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <bench.h>
+#include <core/spatial_index.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+constexpr uint32_t FRAMES = 200;
+
+// 100k boxes spread over a 1 km square, every 20th of them moving each frame
+// like characters and props do. The second run adds what a frame asks of
+// the index: culling for the camera and a batch of trigger spheres.
+void bench_spatial_index() {
+    constexpr uint32_t ENTRY_COUNT = 100000;
+    constexpr uint32_t MOVING_STRIDE = 20;
+    constexpr uint32_t SPHERE_COUNT = 64;
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> coordinate(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> extent(0.1f, 2.0f);
+    std::uniform_real_distribution<float> velocity(-0.05f, 0.05f);
+
+    SpatialIndex index;
+    std::vector<AABB> boxes(ENTRY_COUNT);
+    std::vector<uint32_t> proxies(ENTRY_COUNT);
+    std::vector<Vec3> velocities(ENTRY_COUNT);
+    for (uint32_t entry = 0; entry < ENTRY_COUNT; entry++) {
+        const Vec3 center(coordinate(random), 0.0f, coordinate(random));
+        boxes[entry] = AABB { center - Vec3(extent(random)), center + Vec3(extent(random)) };
+        velocities[entry] = Vec3(velocity(random), 0.0f, velocity(random));
+        proxies[entry] = index.create_proxy(boxes[entry], SpatialCategory::MESH, nullptr);
+    }
+
+    auto move_entries = [&]() {
+        for (uint32_t entry = 0; entry < ENTRY_COUNT; entry += MOVING_STRIDE) {
+            boxes[entry].min += velocities[entry];
+            boxes[entry].max += velocities[entry];
+            index.move_proxy(proxies[entry], boxes[entry]);
+        }
+    };
+
+    const Mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 1000.0f, 0.1f);
+    std::vector<Sphere> spheres(SPHERE_COUNT);
+    std::vector<uint32_t> visible;
+    std::vector<std::vector<uint32_t>> touched;
+
+    measure("100k entries, 5% moving", FRAMES, [&](uint32_t p_frame) {
+        move_entries();
+    });
+    measure("100k entries, 5% moving, culling and spheres", FRAMES, [&](uint32_t p_frame) {
+        move_entries();
+
+        const float angle = 0.01f * float(p_frame);
+        const Vec3 eye(0.0f, 2.0f, 0.0f);
+        const Mat4 view = glm::lookAt(eye, eye + Vec3(std::sin(angle), 0.0f, std::cos(angle)), Vec3(0.0f, 1.0f, 0.0f));
+        visible.clear();
+        index.query_frustum(Frustum::from_matrix(projection * view), SpatialCategory::ALL, visible);
+
+        for (uint32_t sphere = 0; sphere < SPHERE_COUNT; sphere++) {
+            spheres[sphere] = Sphere { boxes[sphere * MOVING_STRIDE].get_center(), 5.0f };
+        }
+        index.query_spheres(spheres, SpatialCategory::ALL, touched);
+        keep(visible.size());
+    });
+    std::println("Height {}, {} reinsertions", index.get_height(), index.reinsertions);
+}
@@ -0,0 +1,92 @@
+#include <bench.h>
+#include <core/node.h>
+#include <core/transform_store.h>
+
+#include <vector>
+
+extern TransformStore gTransforms;
+
+constexpr uint32_t FRAMES = 1000;
+
+// A rig like the animated ones: a spine the limbs hang off, 200 bones in
+// total. Every frame each bone is rotated, as the animation player does, and
+// its world matrix read, as skinning does.
+static void bench_rig() {
+    constexpr uint32_t LIMB_COUNT = 4;
+    constexpr uint32_t LIMB_LENGTH = 40;
+    constexpr uint32_t SPINE_LENGTH = 200 - LIMB_COUNT * LIMB_LENGTH;
+
+    auto root = Node::create("rig");
+    std::vector<Node*> bones;
+    Node* parent = root.get();
+    for (uint32_t index = 0; index < SPINE_LENGTH; index++) {
+        auto bone = Node::create();
+        bone->set_position(0.0f, 0.1f, 0.0f);
+        bones.push_back(bone.get());
+        parent->add_child(bone);
+        parent = bones.back();
+    }
+    for (uint32_t limb = 0; limb < LIMB_COUNT; limb++) {
+        parent = bones[SPINE_LENGTH - 1 - limb];
+        for (uint32_t index = 0; index < LIMB_LENGTH; index++) {
+            auto bone = Node::create();
+            bone->set_position(0.1f, 0.0f, 0.0f);
+            bones.push_back(bone.get());
+            parent->add_child(bone);
+            parent = bones.back();
+        }
+    }
+
+    measure("200 bone rig, all bones animated", FRAMES, [&](uint32_t p_frame) {
+        const float angle = 0.001f * float(p_frame);
+        for (Node* bone : bones) {
+            bone->set_rotation(glm::angleAxis(angle, Vec3(0.0f, 0.0f, 1.0f)));
+        }
+        gTransforms.update();
+        for (Node* bone : bones) {
+            keep(bone->get_world_matrix());
+        }
+    });
+}
+
+// 10k nodes two levels deep, like a level of static props. Nothing moves, so
+// a frame should only cost the world matrix reads. The second run moves the
+// root, which has every global transform resolved again.
+static void bench_static_scene() {
+    constexpr uint32_t GROUP_COUNT = 100;
+    constexpr uint32_t GROUP_SIZE = 99;
+
+    auto root = Node::create("scene");
+    std::vector<Node*> nodes;
+    for (uint32_t group = 0; group < GROUP_COUNT; group++) {
+        auto group_node = Node::create();
+        group_node->set_position(float(group), 0.0f, 0.0f);
+        nodes.push_back(group_node.get());
+        for (uint32_t index = 0; index < GROUP_SIZE; index++) {
+            auto node = Node::create();
+            node->set_position(0.0f, 0.0f, float(index));
+            nodes.push_back(node.get());
+            group_node->add_child(node);
+        }
+        root->add_child(group_node);
+    }
+
+    measure("10k node static scene", FRAMES, [&](uint32_t p_frame) {
+        gTransforms.update();
+        for (Node* node : nodes) {
+            keep(node->get_world_matrix());
+        }
+    });
+    measure("10k node static scene, root moved", FRAMES, [&](uint32_t p_frame) {
+        root->set_position(0.0f, 0.001f * float(p_frame), 0.0f);
+        gTransforms.update();
+        for (Node* node : nodes) {
+            keep(node->get_world_matrix());
+        }
+    });
+}
+
+void bench_transforms() {
+    bench_rig();
+    bench_static_scene();
+}
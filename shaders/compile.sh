@@ -1,6 +1,13 @@
 #!/usr/bin/env bash
+set -e
 
-/opt/shader-slang-bin/bin/slangc -target spirv -emit-spirv-directly -fvk-use-entrypoint-name -source-embed-style u32 -source-embed-name skybox_spv -o shaders/bin/skybox.h $(dirname "$0")/src/skybox.slang
-/opt/shader-slang-bin/bin/slangc -target spirv -emit-spirv-directly -fvk-use-entrypoint-name -source-embed-style u32 -source-embed-name mesh_spv -o shaders/bin/mesh.h $(dirname "$0")/src/mesh.slang
-/opt/shader-slang-bin/bin/slangc -target spirv -emit-spirv-directly -fvk-use-entrypoint-name -source-embed-style u32 -source-embed-name lighting_spv -o shaders/bin/lighting.h $(dirname "$0")/src/lighting.slang
-/opt/shader-slang-bin/bin/slangc -target spirv -emit-spirv-directly -fvk-use-entrypoint-name -source-embed-style u32 -source-embed-name skinning_spv -o shaders/bin/skinning.h $(dirname "$0")/src/skinning.slang
+SLANGC=${SLANGC:-/opt/shader-slang-bin/bin/slangc}
+SPIRV_VAL=${SPIRV_VAL:-spirv-val}
+SLANG_FLAGS="-target spirv -emit-spirv-directly -fvk-use-entrypoint-name"
+
+# Validated with spirv-val before the header is written.
+for shader in skybox mesh lighting skinning; do
+    $SLANGC $SLANG_FLAGS -o /tmp/$shader.spv $(dirname "$0")/src/$shader.slang
+    $SPIRV_VAL --target-env vulkan1.3 /tmp/$shader.spv
+    $SLANGC $SLANG_FLAGS -source-embed-style u32 -source-embed-name ${shader}_spv -o shaders/bin/$shader.h $(dirname "$0")/src/$shader.slang
+done
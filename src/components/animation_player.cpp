@@ -67,7 +67,7 @@ void AnimationPlayer::update(double delta) {
                 if (looped) {
                     previous_root_motion_position -= channel.position_keyframes[channel.position_keyframes.size() - 1].position;
                 }
-                root_motion_velocity = blended_position - previous_root_motion_position;
+                root_motion_velocity = (blended_position - previous_root_motion_position) / std::max(float(delta), 1.0e-6f);
                 previous_root_motion_position = blended_position;
             } else {
                 Vec3 blended_position = current_keyframe.position * (1.0f - weight) + next_keyframe.position * weight;
@@ -93,7 +93,7 @@ void AnimationPlayer::update(double delta) {
                 if (looped) {
                     previous_root_motion_position -= channel.position_keyframes[channel.position_keyframes.size() - 1].position;
                 }
-                root_motion_velocity = blended_position - previous_root_motion_position;
+                root_motion_velocity = (blended_position - previous_root_motion_position) / std::max(float(delta), 1.0e-6f);
                 previous_root_motion_position = blended_position;
             } else {
                 Vec3 blended_position = current_keyframe.position * (1.0f - weight) + next_keyframe.position * weight;
@@ -162,7 +162,6 @@ void AnimationPlayer::update(double delta) {
         }
     }
     
-    skeleton->node->refresh_transform(Transform()); // TODO: Why?
     updating = false;
 }
 
@@ -17,6 +17,7 @@ struct AnimationPlayer : public Component {
     bool playing = true;
 
     Vec3 previous_root_motion_position {};
+    // Per second, so it stays valid when the player ticks at a reduced rate.
     Vec3 root_motion_velocity {};
 
     std::unordered_map<uint32_t, uint32_t> channel_position_index {};
@@ -25,6 +26,16 @@ struct AnimationPlayer : public Component {
     bool updating { false };
     bool interrupted { false };
 
+    static constexpr UpdatePhase update_phase = UpdatePhase::PostPhysics;
+    // Distant and off screen animations are sampled less often.
+    static constexpr TickLOD tick_lod {
+        .max_interval = 4,
+        .full_rate_distance = 15.0f,
+        .distance_step = 10.0f,
+        .hidden_interval = 4,
+        .radius = 2.0f,
+    };
+
     void update(double delta) override;
 
     void play(std::string p_animation_name);
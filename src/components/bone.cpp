@@ -9,7 +9,7 @@ void Bone::update(double _delta) {
         return;
     }
     skeleton->joint_matrices[index] =
-        glm::inverse(skeleton->node->get_global_transform().get_matrix()) * 
-        node->get_global_transform().get_matrix() * 
+        glm::inverse(skeleton->node->get_world_matrix()) * 
+        node->get_world_matrix() * 
         inverse_bind_matrix;
 }
\ No newline at end of file
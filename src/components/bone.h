@@ -8,7 +8,13 @@ struct Skeleton;
 struct Bone : public Component {
     Mat4 inverse_bind_matrix;
     int index;
-    Ref<Skeleton> skeleton;
+    // Non-owning, the skeleton lives on an ancestor of the bone.
+    Skeleton* skeleton { nullptr };
+
+    // Runs once animations have moved the bones and all transforms are
+    // resolved, and only writes its own joint matrix.
+    static constexpr UpdatePhase update_phase = UpdatePhase::PreRender;
+    static constexpr bool thread_safe = true;
     
     void update(double _delta) override;
 };
\ No newline at end of file
@@ -36,9 +36,12 @@ class CameraBodyFilter final : public JPH::BodyFilter {
 CastCollector cast_collector;
 CameraBodyFilter body_filter;
 
+extern NodeRegistry gNodes;
+
 void Camera::update(double delta) {
-    if (follow_target != nullptr) {
-        node->set_position(Math::interpolate(node->get_position(), follow_target->get_global_transform().position + offset, 0.1f, float(delta)));
+    Node* target = gNodes.get(follow_target);
+    if (target != nullptr) {
+        node->set_position(Math::interpolate(node->get_position(), target->get_global_transform().position + offset, 0.1f, float(delta)));
     } else {
         const Vec2 movement_input = Input::get_movement_input();
         Vec3 velocity = get_rotation_matrix() * Vec4(movement_input.x, 0.0f, -movement_input.y, 0.0f);
@@ -96,7 +99,7 @@ void Camera::process_input(SDL_Event& event) {
 Mat4 Camera::get_view_matrix() const {
     Mat4 translation = glm::translate(Mat4(1.0f), node->get_global_transform().position);
     Mat4 rotation = get_rotation_matrix();
-    if (follow_target != nullptr) {
+    if (gNodes.get(follow_target) != nullptr) {
         Mat4 distance = glm::translate(Mat4(1.0f), Vec3(0.0, 0.0, zoom));
         return glm::inverse(translation * rotation * distance);
     } else {
@@ -116,6 +119,12 @@ Mat4 Camera::get_horizontal_rotation_matrix() const {
 }
 
 void Camera::initialize() {
+    Input::subscribe(SDL_EVENT_MOUSE_MOTION, this);
+    Input::subscribe(SDL_EVENT_MOUSE_WHEEL, this);
     body_filter.body_to_exclude = &body_to_exclude;
     shape = new JPH::SphereShape(0.2f);
+}
+
+Camera::~Camera() {
+    Input::unsubscribe(this);
 }
\ No newline at end of file
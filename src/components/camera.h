@@ -2,6 +2,7 @@
 
 #include <math.h>
 #include <core/component.h>
+#include <core/node_registry.h>
 #include <Jolt/Jolt.h>
 #include <Jolt/Physics/Body/BodyID.h>
 
@@ -26,12 +27,15 @@ public:
     float speed {1.0f};
     bool controls_enabled { true };
     bool free_fly { false };
-    Node* follow_target;
+    NodeHandle follow_target {};
     Vec3 offset { 0.0f, 1.4f, 0.0f };
 
     JPH::SphereShape* shape;
     JPH::BodyID body_to_exclude;
 
+    // Follows its target after it has moved this frame.
+    static constexpr UpdatePhase update_phase = UpdatePhase::PostPhysics;
+
     Mat4 get_view_matrix() const;
     Mat4 get_rotation_matrix() const;
     Mat4 get_horizontal_rotation_matrix() const;
@@ -39,4 +43,6 @@ public:
     void update(double delta) override;
     void process_input(SDL_Event& event) override;
     void initialize() override;
+
+    ~Camera();
 };
\ No newline at end of file
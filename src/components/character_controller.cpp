@@ -50,7 +50,7 @@ void CharacterController::initialize() {
     character = new JPH::CharacterVirtual(settings, JPH::RVec3::sZero(), JPH::Quat::sIdentity(), 0, &Physics::physics_system);
     auto camera = scene.camera->get_component<Camera>();
     camera->body_to_exclude = character->GetInnerBodyID();
-    camera->follow_target = node;
+    camera->follow_target = node->get_handle();
     camera->yaw = M_PI_2;
 }
 
@@ -12,6 +12,8 @@ struct CharacterController : public Component {
     Vec3 target_velocity {};
     JPH::CharacterVirtual* character;
 
+    static constexpr UpdatePhase update_phase = UpdatePhase::Physics;
+
     void update(double delta) override;
     void initialize() override;
 
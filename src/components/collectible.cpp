@@ -1,33 +1,51 @@
 #include <components/collectible.h>
 #include <core/node.h>
+#include <core/scene_graph.h>
 #include <util.h>
 #include <yaml.h>
 
 extern Ref<Node> player;
+extern SceneGraph scene;
 
 int Collectible::collected_count = 0;
 int Collectible::total_count = 0;
 
-void Collectible::update(double delta) {
-    if (!enabled || player == nullptr) {
+float Collectible::get_radius() const {
+    return node->get_scale() * 0.15f;
+}
+
+AABB Collectible::get_bounds() const {
+    const Vec3 position = node->get_global_transform().position;
+    const float radius = get_radius();
+    return AABB { position - Vec3(radius), position + Vec3(radius) };
+}
+
+void Collectible::update_triggers(double delta) {
+    if (player == nullptr) {
         return;
     }
 
-    float distance = glm::length(
-        player->get_global_transform().position +
-        Vec3(0.0, 1.0, 0.0) - 
-        node->get_global_transform().position
-    );
-    
-    float radius = node->get_scale() * 0.15f;
-    if (distance < radius) {
-        collected.emit(node);
-        enabled = false;
-        node->visible = false;
-        Collectible::collected_count += 1;
+    const Vec3 position = player->get_global_transform().position + Vec3(0.0, 1.0, 0.0);
+    static std::vector<uint32_t> nearby;
+    nearby.clear();
+    scene.spatial.query_sphere(Sphere { position, 0.0f }, SpatialCategory::TRIGGER, nearby);
+
+    for (uint32_t proxy : nearby) {
+        auto collectible = static_cast<Collectible*>(scene.spatial.get_user_data(proxy));
+        if (!collectible->enabled || !collectible->node->is_active_in_tree()) {
+            continue;
+        }
+
+        float distance = glm::length(position - collectible->node->get_global_transform().position);
+        if (distance < collectible->get_radius()) {
+            collectible->collected.emit(collectible->node);
+            collectible->enabled = false;
+            scene.commands.set_visible(collectible->node->get_handle(), false);
+            Collectible::collected_count += 1;
+        }
     }
 }
 
 COMPONENT_FACTORY_IMPL(Collectible, collectible) {
     Collectible::total_count += 1;
-}
\ No newline at end of file
+}
@@ -2,16 +2,23 @@
 
 #include <core/component.h>
 #include <core/signal.h>
+#include <core/spatial_index.h>
 
 
 struct Collectible : Component {
     Signal<Node*> collected {};
     bool enabled { true };
+    SpatialProxy proxy;
     
     static int collected_count;
     static int total_count;
 
-    void update(double delta) override;
+    float get_radius() const;
+    AABB get_bounds() const;
+
+    // Looks up the collectibles around the player in the scene's spatial
+    // index, instead of every collectible measuring its own distance.
+    static void update_triggers(double delta);
 
     COMPONENT_FACTORY_H(Collectible)
 };
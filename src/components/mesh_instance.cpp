@@ -4,23 +4,38 @@
 
 
 void MeshInstance::draw(const Mat4& p_transform, DrawContext& p_context) const {
-    Mat4 node_matrix = p_transform * node->get_global_transform().get_matrix();
+    Mat4 node_matrix = p_transform * node->get_world_matrix();
+    // Skinned meshes are drawn from the vertices the skinning shader decoded.
+    const bool skinned = (*mesh)->mesh_buffers.skinning_data_buffer.buffer != VK_NULL_HANDLE;
     
     for (auto& surface : (*mesh)->surfaces) {
+        MaterialInstance* material = materials[surface.material_index].get();
         RenderObject object {
             .index_count = surface.count,
             .first_index = surface.start_index,
             .index_buffer = (*mesh)->mesh_buffers.index_buffer.buffer,
-            .material = (surface.material).get(),
+            .index_type = surface.index_type,
+            .vertex_offset = surface.vertex_offset,
+            .material = material,
             .transform = node_matrix,
             .vertex_buffer_address = (*mesh)->mesh_buffers.vertex_buffer_address,
             .skinned_vertex_buffer_address = (*mesh)->mesh_buffers.skinned_vertex_buffer_address,
+            .compressed_vertices = (*mesh)->compressed_vertices && !skinned,
+            .position_offset = Vec4((*mesh)->position_offset, 0.0f),
+            .position_scale = Vec4((*mesh)->position_scale, 0.0f),
         };
 
-        if (surface.material->pass_type == MaterialPass::Transparent) {
+        if (material->pass_type == MaterialPass::Transparent) {
             p_context.transparent_surfaces.emplace_back(object);
         } else {
             p_context.opaque_surfaces.emplace_back(object);
         }
     }
-}
\ No newline at end of file
+}
+
+AABB MeshInstance::get_bounds() const {
+    if (!cull) {
+        return AABB { Vec3(-1.0e9f), Vec3(1.0e9f) };
+    }
+    return (*mesh)->bounds.transform(node->get_world_matrix());
+}
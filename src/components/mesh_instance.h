@@ -1,6 +1,7 @@
 #pragma once
 #include <core/component.h>
 #include <core/resource.h>
+#include <core/spatial_index.h>
 #include <resources/mesh.h>
 #include <util.h>
 
@@ -8,8 +9,15 @@ struct DrawContect;
 
 struct MeshInstance : public Component {
     Ref<Resource<Mesh>> mesh;
+    // By MeshSurface::material_index.
+    std::vector<Ref<MaterialInstance>> materials;
+    // Instances that aren't culled get unbounded proxies, so every frustum
+    // query reports them.
+    bool cull { true };
+    SpatialProxy proxy;
 
     void draw(const Mat4& p_transform, DrawContext& p_context) const override;
+    AABB get_bounds() const;
 
     MeshInstance() {}
-};
\ No newline at end of file
+};
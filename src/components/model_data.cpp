@@ -9,6 +9,7 @@
 #include <components/physics/static_body.h>
 #include <rendering/renderer.h>
 #include <resources/animation.h>
+#include <resources/imported_model.h>
 
 #include <yaml.h>
 
@@ -17,6 +18,30 @@
 #include <Jolt/Physics/Collision/Shape/MeshShape.h>
 
 extern Renderer gRenderer;
+extern NodeRegistry gNodes;
+
+// Bit per texture slot of the material that is loaded.
+static uint8_t get_loaded_mask(const MaterialMetallicRoughness::MaterialResources& p_resources) {
+    return (p_resources.albedo_texture->loaded()          ? 1 : 0)
+         | (p_resources.normal_texture->loaded()          ? 2 : 0)
+         | (p_resources.metal_roughness_texture->loaded() ? 4 : 0);
+}
+
+void ModelData::write_material(uint32_t p_index) {
+    const auto& resources = material_resources_list[p_index];
+    // Written into a new descriptor set, the old one may still be in use by
+    // frames in flight.
+    *materials[std::to_string(p_index)] = gRenderer.metal_roughness_material.write_material(gRenderer.device, MaterialPass::MainColor, resources, descriptor_pool);
+    material_loaded_masks[p_index] = get_loaded_mask(resources);
+}
+
+void ModelData::refresh_materials() {
+    for (uint32_t index = 0; index < material_resources_list.size(); index++) {
+        if (get_loaded_mask(material_resources_list[index]) != material_loaded_masks[index]) {
+            write_material(index);
+        }
+    }
+}
 
 void ModelData::cleanup() {
     Device device = renderer->device;
@@ -39,52 +64,32 @@ void ModelData::cleanup() {
 void ModelData::initialize() {
     std::string imported_path = std::format("{}.imported", model_path);
     // TODO: Check if file changed
-    if (!std::filesystem::exists(imported_path)) {
-        import_gltf_scene(&gRenderer, model_path);
+    const bool settings_changed = compress_vertices.has_value() && get_imported_compress_vertices(model_path) != compress_vertices;
+    if (settings_changed || ImportedModel::needs_import(imported_path)) {
+        print("Importing %s", model_path.c_str());
+        import_gltf_scene(&gRenderer, model_path, compress_vertices);
     }
 
     print("Loading imported GLTF: %s", imported_path.c_str());
-    std::fstream file(imported_path, std::fstream::in | std::fstream::binary);
-    
-    auto mesh_guid = std::format("{}::/meshes/{}", imported_path.c_str(), "x");
-    meshes["x"] = ResourceManager::get<Mesh>(mesh_guid.c_str());
+    ImportedModel model;
+    if (!ImportedModel::read(imported_path, model)) {
+        print("Could not read %s!", imported_path.c_str());
+        return;
+    }
+    const ResourceID mesh_id = model.mesh_id;
+    meshes["x"] = ResourceManager::get<Mesh>(mesh_id);
     auto& mesh = *meshes["x"];
     
     materials["default"] = std::make_shared<MaterialInstance>(gRenderer.default_material);
 
     // Samplers
-    std::string line;
-    std::getline(file, line);
-    assert(line == "Samplers");
-    std::getline(file, line);
-    uint32_t sampler_count = stoi(line);
-
-    std::vector<SamplerCreateInfo> sampler_infos;
-    sampler_infos.resize(sampler_count);
-    file.read(reinterpret_cast<char*>(sampler_infos.data()), sampler_count * sizeof(SamplerCreateInfo));
-    for (auto sampler_info : sampler_infos) {
-        auto[result, new_sampler] = gRenderer.device.createSampler(sampler_info);
+    for (const auto& sampler : model.samplers) {
+        auto[result, new_sampler] = gRenderer.device.createSampler(sampler.get_create_info());
         samplers.push_back(new_sampler);
     }
 
-    // Textures
-    std::vector<std::optional<AllocatedImage>> temp_textures;
-    std::vector<std::string> texture_paths;
-    std::getline(file, line);
-    assert(line == "Textures");
-    std::getline(file, line);
-    uint32_t texture_count = std::stoi(line);
-    temp_textures.resize(texture_count);
-    for (uint32_t texture_index = 0; texture_index < texture_count; texture_index++) {
-        std::getline(file, line);
-        texture_paths.push_back(line);
-    }
-
     // Material data
-    std::getline(file, line);
-    assert(line == "Materials");
-    std::getline(file, line);
-    uint32_t material_count = std::stoi(line);
+    const uint32_t material_count = model.materials.size();
 
     PhysicalDeviceProperties physical_device_properties = gRenderer.physical_device.getProperties();
     uint32_t min_offset_multiplier = ceilf(float(sizeof(MaterialMetallicRoughness::MaterialResources)) / float(physical_device_properties.limits.minUniformBufferOffsetAlignment));
@@ -104,265 +109,212 @@ void ModelData::initialize() {
     );
     MaterialMetallicRoughness::MaterialConstants* scene_material_constants = (MaterialMetallicRoughness::MaterialConstants*) material_data_buffer.info.pMappedData;
 
+    // Textures load on the loader threads. Materials start out with default
+    // textures in their place and are written again as the textures arrive.
+    auto on_texture_loaded = [handle = node->get_handle()](Ref<Resource<Texture>> p_texture) {
+        Node* owner = gNodes.get(handle);
+        if (owner == nullptr) return;
+        if (auto model_data = owner->try_get_component<ModelData>()) {
+            model_data->refresh_materials();
+        }
+    };
+    auto request_texture = [&](int p_image_index, vk::Format p_format, Ref<Resource<Texture>>& p_texture) {
+        if (p_image_index < 0 || p_image_index >= model.textures.size()) return;
+        const ImportedTexture& texture = model.textures[p_image_index];
+        if (!texture.id.is_valid()) return;
+        p_texture = ResourceManager::load_async<Texture>(texture.id, std::string(model.get_string(texture.path)), on_texture_loaded, p_format);
+        p_texture->reference();
+        textures.push_back(p_texture);
+    };
+
     for (uint32_t material_index = 0; material_index < material_count; material_index++) {
+        const ImportedMaterial& material = model.materials[material_index];
         MaterialMetallicRoughness::MaterialConstants constants {
-            .albedo_factors = Vec4(1.0f),
-            .metal_roughness_factors = Vec4(0.0f, 1.0f, 0.0f, 0.0f)
+            .albedo_factors = Vec4(material.albedo_factors[0], material.albedo_factors[1], material.albedo_factors[2], material.albedo_factors[3]),
+            .metal_roughness_factors = Vec4(material.metallic, material.roughness, 0.0f, 0.0f)
         };
 
-        std::getline(file, line);
-        constants.albedo_factors.r = std::stof(line);
-        std::getline(file, line);
-        constants.albedo_factors.g = std::stof(line);
-        std::getline(file, line);
-        constants.albedo_factors.b = std::stof(line);
-        std::getline(file, line);
-        constants.albedo_factors.a = std::stof(line);
-        std::getline(file, line);
-        constants.metal_roughness_factors.r = std::stof(line);
-        std::getline(file, line);
-        constants.metal_roughness_factors.g = std::stof(line);
-        
         scene_material_constants[material_index] = constants;
         
         MaterialMetallicRoughness::MaterialResources material_resources {
-            .albedo_texture = ResourceManager::get<Texture>("::image_white"),
+            .albedo_texture = ResourceManager::get<Texture>(IMAGE_WHITE),
             .albedo_sampler = gRenderer.sampler_default_nearest,
-            .normal_texture = ResourceManager::get<Texture>("::image_default_normal"),
+            .normal_texture = ResourceManager::get<Texture>(IMAGE_DEFAULT_NORMAL),
             .normal_sampler = gRenderer.sampler_default_nearest,
-            .metal_roughness_texture = ResourceManager::get<Texture>("::image_white"),
+            .metal_roughness_texture = ResourceManager::get<Texture>(IMAGE_WHITE),
             .metal_roughness_sampler = gRenderer.sampler_default_linear,
             .data_buffer = material_data_buffer.buffer,
             .data_buffer_offset = material_index * (uint32_t)sizeof(MaterialMetallicRoughness::MaterialConstants),
         };
 
         // Albedo
-        std::getline(file, line);
-        int albedo_image_index = std::stoi(line);
-        if (albedo_image_index > -1) {
-            auto texture_guid = texture_paths[albedo_image_index].c_str();
-            material_resources.albedo_texture = ResourceManager::get<Texture>(texture_guid);
-            auto &tex = *material_resources.albedo_texture;
-            if (!tex.loaded()) {
-                ResourceManager::load<Texture>(texture_guid, vk::Format::eR8G8B8A8Srgb);
-                tex.set_load_status(LoadStatus::LOADED);
-            } else {
-                std::println("Reusing texture: {}", texture_guid);
-            }
-            tex.reference();
-            textures.push_back(material_resources.albedo_texture);
-        }
-        std::getline(file, line);
-        int albedo_sampler_index = std::stoi(line);
-        if (albedo_sampler_index > -1) {
-            material_resources.albedo_sampler = samplers[albedo_sampler_index];
+        request_texture(material.albedo_image, vk::Format::eR8G8B8A8Srgb, material_resources.albedo_texture);
+        if (material.albedo_sampler > -1 && material.albedo_sampler < samplers.size()) {
+            material_resources.albedo_sampler = samplers[material.albedo_sampler];
         }
 
         // Normal
-        std::getline(file, line);
-        int normal_image_index = std::stoi(line);
-        if (normal_image_index > -1) {
-            auto texture_guid = texture_paths[normal_image_index].c_str();
-            material_resources.normal_texture = ResourceManager::get<Texture>(texture_guid);
-            if (!material_resources.normal_texture->loaded()) {
-                ResourceManager::load<Texture>(texture_guid, vk::Format::eR8G8B8A8Unorm);
-            } else {
-                std::println("Reusing texture: {}", texture_guid);
-            }
-            material_resources.normal_texture->reference();
-            textures.push_back(material_resources.normal_texture);
-        }
-        std::getline(file, line);
-        int normal_sampler_index = std::stoi(line);
-        if (normal_sampler_index > -1) {
-            material_resources.normal_sampler = samplers[normal_sampler_index];
+        request_texture(material.normal_image, vk::Format::eR8G8B8A8Unorm, material_resources.normal_texture);
+        if (material.normal_sampler > -1 && material.normal_sampler < samplers.size()) {
+            material_resources.normal_sampler = samplers[material.normal_sampler];
         }
 
         // Metal/Roughness
-        std::getline(file, line);
-        int metal_roughness_image_index = std::stoi(line);
-        if (metal_roughness_image_index > -1) {
-            auto texture_guid = texture_paths[metal_roughness_image_index].c_str();
-            material_resources.metal_roughness_texture = ResourceManager::get<Texture>(texture_guid);
-            if (!material_resources.metal_roughness_texture->loaded()) {
-                ResourceManager::load<Texture>(texture_guid, vk::Format::eR8G8B8A8Unorm);
-            } else {
-                std::println("Reusing texture: {}", texture_guid);
-            }
-            material_resources.metal_roughness_texture->reference();
-            textures.push_back(material_resources.metal_roughness_texture);
-        }
-        std::getline(file, line);
-        int metal_roughness_sampler_index = std::stoi(line);
-        if (metal_roughness_sampler_index > -1) {
-            material_resources.metal_roughness_sampler = samplers[metal_roughness_sampler_index];
+        request_texture(material.metal_roughness_image, vk::Format::eR8G8B8A8Unorm, material_resources.metal_roughness_texture);
+        if (material.metal_roughness_sampler > -1 && material.metal_roughness_sampler < samplers.size()) {
+            material_resources.metal_roughness_sampler = samplers[material.metal_roughness_sampler];
         }
 
-        auto material = gRenderer.metal_roughness_material.write_material(gRenderer.device, MaterialPass::MainColor, material_resources, descriptor_pool);
-        materials[std::to_string(material_index)] = std::make_shared<MaterialInstance>(material);
+        materials[std::to_string(material_index)] = std::make_shared<MaterialInstance>();
+        material_resources_list.push_back(material_resources);
+        material_loaded_masks.push_back(0);
+        write_material(material_index);
     }
     
     // Animations
-    std::getline(file, line);
-    assert(line == "Animations");
-    std::getline(file, line);
-    int animation_count = std::stoi(line);
-    for (uint32_t animation_index = 0; animation_index < animation_count; animation_index++) {
+    for (const auto& imported_animation : model.animations) {
         Animation animation {};
-        std::getline(file, line);
-        std::string animation_name = line;
-        
-        std::getline(file, line);
-        animation.length = std::stof(line);
-        
-        std::getline(file, line);
-        uint32_t channel_count = std::stoi(line);
-        for (uint32_t channel_index = 0; channel_index < channel_count; channel_index++) {
-            std::getline(file, line);
-            uint32_t bone_index = std::stoi(line);
-            animation.channels[bone_index] = AnimationChannel {};
-
-            std::getline(file, line);
-            uint32_t position_keyframe_count = std::stoi(line);
-            for (uint32_t position_keyframe_index = 0; position_keyframe_index < position_keyframe_count; position_keyframe_index++) {
-                KeyframePosition keyframe;
-                std::getline(file, line);
-                keyframe.time = std::stof(line);
-                std::getline(file, line);
-                keyframe.position.x = std::stof(line);
-                std::getline(file, line);
-                keyframe.position.y = std::stof(line);
-                std::getline(file, line);
-                keyframe.position.z = std::stof(line);
-                animation.channels[bone_index].position_keyframes.push_back(keyframe);
+        animation.length = imported_animation.length;
+        for (uint32_t channel_index = 0; channel_index < imported_animation.channel_count; channel_index++) {
+            const ImportedChannel& imported_channel = model.channels[imported_animation.first_channel + channel_index];
+            AnimationChannel& channel = animation.channels[imported_channel.node_index];
+
+            channel.position_keyframes.resize(imported_channel.position_count);
+            for (uint32_t key_index = 0; key_index < imported_channel.position_count; key_index++) {
+                const ImportedPositionKey& key = model.position_keys[imported_channel.first_position + key_index];
+                channel.position_keyframes[key_index].time = key.time;
+                channel.position_keyframes[key_index].position = Vec3(key.position[0], key.position[1], key.position[2]);
             }
 
-            std::getline(file, line);
-            uint32_t rotation_keyframe_count = std::stoi(line);
-            for (uint32_t rotation_keyframe_index = 0; rotation_keyframe_index < rotation_keyframe_count; rotation_keyframe_index++) {
-                KeyframeRotation keyframe;
-                std::getline(file, line);
-                keyframe.time = std::stof(line);
-                std::getline(file, line);
-                keyframe.rotation.x = std::stof(line);
-                std::getline(file, line);
-                keyframe.rotation.y = std::stof(line);
-                std::getline(file, line);
-                keyframe.rotation.z = std::stof(line);
-                std::getline(file, line);
-                keyframe.rotation.w = std::stof(line);
-                animation.channels[bone_index].rotation_keyframes.push_back(keyframe);
+            channel.rotation_keyframes.resize(imported_channel.rotation_count);
+            for (uint32_t key_index = 0; key_index < imported_channel.rotation_count; key_index++) {
+                const ImportedRotationKey& key = model.rotation_keys[imported_channel.first_rotation + key_index];
+                channel.rotation_keyframes[key_index].time = key.time;
+                channel.rotation_keyframes[key_index].rotation = Quaternion(key.rotation[3], key.rotation[0], key.rotation[1], key.rotation[2]);
             }
         }
-        animation_library.animations[animation_name] = animation;
+        animation_library.animations[std::string(model.get_string(imported_animation.name))] = animation;
     }
 
     // Meshes
+    // Vertex data, mapped from the shared cache and copied from there into
+    // staging memory. Inline in the oldest files. The joints are needed even
+    // if the mesh is reused, every model builds its own skeleton.
+    ImportedMeshView data;
+    if (model.inline_mesh_data.has_value()) {
+        data = ImportedMeshView::from(std::move(*model.inline_mesh_data));
+    } else if (!ImportedMeshView::open(std::string(model.get_string(model.mesh_blob)), data)) {
+        print("Could not read the vertex data of %s!", imported_path.c_str());
+    }
+    const auto joint_data = data.joint_data;
+    const uint32_t joint_count = joint_data.size();
+
+    Ref<Node> skeleton_node;
+    std::vector<Mat4> joint_matrices;
+    if (joint_count > 0) {
+        skeleton_node = Node::create("Skeleton");
+        skeleton = skeleton_node->add_component<Skeleton>();
+        if (root_motion_index >= 0) {
+            skeleton->root_motion_index = root_motion_index;
+        }
+        skeleton->joint_matrices.resize(joint_count);
+        
+        skeleton->bones.resize(joint_count);
+        
+        joint_matrices.resize(joint_count);
+        for (int i = 0; i < joint_count; i++) {
+            skeleton->bones[i] = Node::create("Bone");
+            auto bone = skeleton->bones[i]->add_component<Bone>();
+            bone->skeleton = skeleton.get();
+            bone->index = i;
+            bone->inverse_bind_matrix = joint_data[i].inverse_bind_matrix;
+            skeleton->bones[i]->set_position(joint_data[i].position);
+            skeleton->bones[i]->set_rotation(joint_data[i].rotation);
+            skeleton->bones[i]->set_scale(joint_data[i].scale);
+        }
+
+        for (int i = 0; i < joint_count; i++) {
+            if (joint_data[i].parent_index == -1) {
+                skeleton_node->add_child(skeleton->bones[i]);
+            } else {
+                skeleton->bones[joint_data[i].parent_index]->add_child(skeleton->bones[i]);
+            }
+        }
+
+        for (int i = 0; i < joint_count; i++) {
+            joint_matrices[i] = skeleton->bones[i]->get_global_transform().get_matrix() * joint_data[i].inverse_bind_matrix;
+        }
+    }
+
     if (!mesh.loaded()) {
-        std::println("Loading mesh: {}", mesh_guid.c_str());
+        std::println("Loading mesh: {}", mesh_id.get_name());
 
         // Surfaces
-        while (true) {
-            std::getline(file, line);
-            if (line == "") {
-                break;
-            }
-            uint32_t start_index = std::stoi(line);
-            std::getline(file, line);
-            uint32_t count = std::stoi(line);
-            std::getline(file, line);
-            uint32_t material_index = std::stoi(line);
+        for (const auto& surface : model.surfaces) {
             mesh->surfaces.emplace_back(MeshSurface {
-                start_index,
-                count,
-                materials[std::to_string(material_index)],
+                surface.start_index,
+                surface.count,
+                surface.material_index >= 0 ? uint32_t(surface.material_index) : material_count,
+                surface.vertex_offset,
+                surface.index_size == sizeof(uint16_t) ? IndexType::eUint16 : IndexType::eUint32,
             });
         }
 
-        // Vertex data
-        std::getline(file, line);
-        uint32_t vertex_count = std::stoi(line);
-        std::getline(file, line);
-        uint32_t index_count = std::stoi(line);
-        std::getline(file, line);
-        uint32_t skinning_data_count = std::stoi(line);
-        std::getline(file, line);
-        uint32_t joint_count = std::stoi(line);
-
-        std::vector<Vertex> vertices;
-        std::vector<uint32_t> indices;
-        std::vector<SkinningData> skinning_data;
-        std::vector<JointData> joint_data;
-
-        vertices.resize(vertex_count);
-        indices.resize(index_count);
-        skinning_data.resize(skinning_data_count);
-        joint_data.resize(joint_count);
-        
-        file.read(reinterpret_cast<char*>(vertices.data()), vertex_count * sizeof(Vertex));
-        file.read(reinterpret_cast<char*>(indices.data()), index_count * sizeof(uint32_t));
-        file.read(reinterpret_cast<char*>(skinning_data.data()), skinning_data_count * sizeof(SkinningData));
-        file.read(reinterpret_cast<char*>(joint_data.data()), joint_count * sizeof(JointData));
+        const auto vertices = data.vertices;
+        const auto indices = data.index_data.empty() ? std::as_bytes(data.indices) : std::as_bytes(data.index_data);
+        const auto skinning_data = data.skinning_data;
+        const auto compressed_vertices = data.compressed_vertices;
+        const bool compressed = !compressed_vertices.empty();
 
         if (joint_count > 0) {
-            auto skeleton_node = Node::create("Skeleton");
-            skeleton = std::make_shared<Skeleton>();
-            if (root_motion_index >= 0) {
-                skeleton->root_motion_index = root_motion_index;
-            }
-            skeleton->joint_matrices.resize(joint_count);
-            skeleton_node->add_component<Skeleton>(skeleton);
-            
-            skeleton->bones.resize(joint_count);
-            
-            std::vector<Mat4> joint_matrices;
-            joint_matrices.resize(joint_count);
-            for (int i = 0; i < joint_count; i++) {
-                skeleton->bones[i] = Node::create("Bone");
-                auto bone = std::make_shared<Bone>();
-                bone->skeleton = skeleton;
-                bone->index = i;
-                bone->inverse_bind_matrix = joint_data[i].inverse_bind_matrix;
-                skeleton->bones[i]->add_component<Bone>(bone);
-                skeleton->bones[i]->set_position(joint_data[i].position);
-                skeleton->bones[i]->set_rotation(joint_data[i].rotation);
-                skeleton->bones[i]->set_scale(joint_data[i].scale);
-            }
-
-            for (int i = 0; i < joint_count; i++) {
-                if (joint_data[i].parent_index == -1) {
-                    skeleton_node->add_child(skeleton->bones[i]);
-                } else {
-                    skeleton->bones[joint_data[i].parent_index]->add_child(skeleton->bones[i]);
-                }
-            }
-
-            skeleton_node->refresh_transform(Transform());
-
-            for (int i = 0; i < joint_count; i++) {
-                joint_matrices[i] = skeleton->bones[i]->get_global_transform().get_matrix() * joint_data[i].inverse_bind_matrix;
-            }
-
-            mesh->mesh_buffers = gRenderer.upload_mesh(indices, vertices, skinning_data, joint_matrices);
-            skeleton->joint_matrices_buffer = &(mesh->mesh_buffers.joint_matrices_buffer);
-            node->add_child(skeleton_node);
+            mesh->mesh_buffers = compressed
+                ? gRenderer.upload_mesh(indices, compressed_vertices, skinning_data, joint_matrices)
+                : gRenderer.upload_mesh(indices, vertices, skinning_data, joint_matrices);
         } else {
-            mesh->mesh_buffers = gRenderer.upload_mesh(indices, vertices);
+            mesh->mesh_buffers = compressed
+                ? gRenderer.upload_mesh(indices, compressed_vertices)
+                : gRenderer.upload_mesh(indices, vertices);
         }
         
-        mesh->vertex_count = vertices.size();
+        if (compressed) {
+            // Bounds of the quantization grid, as tight as the vertices.
+            const ImportedVertexQuantization& quantization = data.quantization;
+            mesh->compressed_vertices = true;
+            mesh->position_offset = Vec3(quantization.position_offset[0], quantization.position_offset[1], quantization.position_offset[2]);
+            mesh->position_scale = Vec3(quantization.position_scale[0], quantization.position_scale[1], quantization.position_scale[2]);
+            mesh->vertex_count = compressed_vertices.size();
+            mesh->bounds = AABB { mesh->position_offset, mesh->position_offset + mesh->position_scale * 65535.0f };
+        } else {
+            mesh->vertex_count = vertices.size();
+            if (!vertices.empty()) {
+                mesh->bounds = AABB { vertices[0].position, vertices[0].position };
+                for (const auto& vertex : vertices) {
+                    mesh->bounds.min = glm::min(mesh->bounds.min, vertex.position);
+                    mesh->bounds.max = glm::max(mesh->bounds.max, vertex.position);
+                }
+            }
+        }
         mesh.set_load_status(LoadStatus::LOADED);
     } else {
-        std::println("Reusing mesh: {}", mesh_guid.c_str());
+        std::println("Reusing mesh: {}", mesh_id.get_name());
     }
     mesh.reference();
 
-    file.close();
+    if (skeleton_node) {
+        skeleton->joint_matrices_buffer = &(mesh->mesh_buffers.joint_matrices_buffer);
+        node->add_child(skeleton_node);
+    }
     
     // Nodes
     auto mesh_instance = node->add_component<MeshInstance>();
     mesh_instance->mesh = meshes["x"];
-    node->refresh_transform(Transform());
+    for (uint32_t material_index = 0; material_index < material_count; material_index++) {
+        mesh_instance->materials.push_back(materials[std::to_string(material_index)]);
+    }
+    // For surfaces without a material.
+    mesh_instance->materials.push_back(materials["default"]);
+    // Animated vertices can leave the bind pose bounds.
+    mesh_instance->cull = !skinned;
 
     if (skinned) {
         auto skinning = node->add_component<SkinnedMesh>();
@@ -401,4 +353,7 @@ COMPONENT_FACTORY_IMPL(ModelData, model) {
     if (p_data["root_motion_index"]) {
         root_motion_index = p_data["root_motion_index"].as<int>();
     }
+    if (p_data["compress_vertices"]) {
+        compress_vertices = p_data["compress_vertices"].as<bool>();
+    }
 }
\ No newline at end of file
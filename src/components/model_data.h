@@ -7,6 +7,7 @@
 #include <resources/texture.h>
 #include <rendering/types.h>
 #include <rendering/descriptors.h>
+#include <rendering/renderer.h>
 
 class Renderer;
 struct Skeleton;
@@ -15,6 +16,9 @@ struct ModelData : public Component {
     std::unordered_map<std::string, Ref<Resource<Mesh>>> meshes;
     std::vector<Ref<Resource<Texture>>> textures;
     std::unordered_map<std::string, Ref<MaterialInstance>> materials;
+    // By material index, to write materials again once their textures loaded.
+    std::vector<MaterialMetallicRoughness::MaterialResources> material_resources_list;
+    std::vector<uint8_t> material_loaded_masks;
 
     std::vector<Sampler> samplers;
     DescriptorAllocatorGrowable descriptor_pool;
@@ -27,9 +31,16 @@ struct ModelData : public Component {
     AnimationLibrary animation_library {};
     bool skinned { false };
     int root_motion_index { -1 };
+    // Overrides the import setting, the model is imported again on a change.
+    std::optional<bool> compress_vertices;
 
     void initialize() override;
     virtual void cleanup() override;
 
+    // Writes the materials again whose textures finished loading since.
+    void refresh_materials();
+
     COMPONENT_FACTORY_H(ModelData)
+
+    void write_material(uint32_t p_index);
 };
\ No newline at end of file
@@ -14,6 +14,12 @@ struct RigidBody : public Component {
 
     Vec3 linear_velocity;
 
+    // Copies the simulated body back onto its node. The body interface locks
+    // internally, each body only writes its own node and marking it dirty is
+    // deferred to the main thread.
+    static constexpr UpdatePhase update_phase = UpdatePhase::Physics;
+    static constexpr bool thread_safe = true;
+
     void initialize() override;
     void set_linear_velocity(Vec3 p_linear_velocity);
     Vec3 get_linear_velocity() const;
@@ -1,20 +1,11 @@
 #include <components/point_light.h>
 #include <core/node.h>
-#include <core/scene_graph.h>
-#include <rendering/types.h>
 
 #include <yaml.h>
 
-extern SceneGraph scene; // TODO: don't
-
-void PointLight::update(double _delta) {
-    scene.point_lights.emplace_back(
-        GPUPointLight {
-            .position = node->get_global_transform().position,
-            .intensity = intensity,
-            .color = color,
-        }
-    );
+AABB PointLight::get_bounds() const {
+    const Vec3 position = node->get_global_transform().position;
+    return AABB { position, position };
 }
 
 COMPONENT_FACTORY_IMPL(PointLight, point_light) {
@@ -1,11 +1,13 @@
 #pragma once
 #include <core/component.h>
+#include <core/spatial_index.h>
 
 struct PointLight : public Component {
     Vec3 color;
     float intensity;
+    SpatialProxy proxy;
 
-    void update(double _delta) override;
+    AABB get_bounds() const;
 
     COMPONENT_FACTORY_H(PointLight)
-};
\ No newline at end of file
+};
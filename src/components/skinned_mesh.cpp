@@ -8,6 +8,9 @@ void SkinnedMesh::draw(const Mat4& p_transform, DrawContext& p_context) const {
         .output_vertex_buffer_address  = (*mesh)->mesh_buffers.skinned_vertex_buffer_address,
         .skinning_data_buffer_address  = (*mesh)->mesh_buffers.skinning_data_buffer_address,
         .joint_matrices_buffer_address = (*mesh)->mesh_buffers.joint_matrices_buffer_address,
+        .compressed_vertices = (*mesh)->compressed_vertices,
+        .position_offset = Vec4((*mesh)->position_offset, 0.0f),
+        .position_scale = Vec4((*mesh)->position_scale, 0.0f),
     });
 }
 
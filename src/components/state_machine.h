@@ -18,7 +18,7 @@ namespace State {
     struct State {
         StateMachine* state_machine;
         Node* actor;
-        Ref<AnimationPlayer> anim_player;
+        AnimationPlayer* anim_player { nullptr };
 
         template<typename... Ts>
         void enter(Ts... p_config);
@@ -61,7 +61,7 @@ struct StateMachine : public Component {
         states[&typeid(T)] = std::make_shared<T>();
         states[&typeid(T)]->state_machine = this;
         states[&typeid(T)]->actor = node;
-        states[&typeid(T)]->anim_player = node->get_component<AnimationPlayer>();
+        states[&typeid(T)]->anim_player = node->try_get_component<AnimationPlayer>();
     }
 
     void update(double delta) override {
@@ -1,6 +1,8 @@
 #pragma once
 #include <math.h>
 #include <util.h>
+#include <cassert>
+#include <cstdint>
 
 struct DrawContext;
 struct Node;
@@ -31,8 +33,44 @@ class::class(YAML::Node p_data)
 // ----------------------
 
 
+// Phases of a scene update, in the order they run each frame.
+enum class UpdatePhase : uint32_t {
+    Input,
+    PrePhysics,
+    Physics,
+    PostPhysics,
+    PreRender,
+};
+constexpr uint32_t UPDATE_PHASE_COUNT = 5;
+
+// Lets the components of a type update less often while they are far from
+// the camera or out of view. Skipped frames are not lost, the next update
+// receives the delta accumulated since the previous one.
+struct TickLOD {
+    // Upper bound for the frames between two updates, 1 disables the LOD.
+    uint32_t max_interval { 1 };
+    // Closer than this to the camera, components update every frame.
+    float full_rate_distance { 10.0f };
+    // Every further step of this distance adds a frame to the interval.
+    float distance_step { 10.0f };
+    // Lower bound for the interval while outside the view.
+    uint32_t hidden_interval { 1 };
+    // Radius around the node used to test if it is in view.
+    float radius { 1.0f };
+};
+
 struct Component {
     Node* node;
+    uint32_t pool_index;
+
+    // Scheduling of update(), overridden by redeclaring these as static
+    // constexpr members in the subclass. Within a phase, pools with a lower
+    // update order finish first. Pools with the same order may run at the
+    // same time, and thread safe ones are split across worker threads.
+    static constexpr UpdatePhase update_phase = UpdatePhase::PrePhysics;
+    static constexpr int update_order = 0;
+    static constexpr bool thread_safe = false;
+    static constexpr TickLOD tick_lod {};
 
     static std::unordered_map<std::string, void(*)(YAML::Node, std::shared_ptr<Node>)> create_functions;
 
@@ -43,4 +81,24 @@ struct Component {
     virtual void cleanup() {}
 
     static bool register_type(const std::string p_name, void(*)(YAML::Node, std::shared_ptr<Node>));
+};
+
+// Dense per-type index, assigned the first time a component type is used.
+// Indexes into Node's component mask, so at most 64 types are supported.
+struct ComponentType {
+    static constexpr uint32_t MAX_TYPES = 64;
+
+    template<typename T>
+    static uint32_t id() {
+        static const uint32_t type_id = next_id();
+        return type_id;
+    }
+
+private:
+    inline static uint32_t counter { 0 };
+
+    static uint32_t next_id() {
+        assert(counter < MAX_TYPES);
+        return counter++;
+    }
 };
\ No newline at end of file
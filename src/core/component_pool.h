@@ -0,0 +1,257 @@
+#pragma once
+
+#include <core/component.h>
+#include <core/slab_allocator.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// A component type overrides one of the Component hooks if taking the member
+// pointer through the derived type yields a different type than the base one.
+template<typename T>
+constexpr bool overrides_update = !std::is_same_v<decltype(&T::update), decltype(&Component::update)>;
+
+template<typename T>
+constexpr bool overrides_draw = !std::is_same_v<decltype(&T::draw), decltype(&Component::draw)>;
+
+
+// Where the scene is viewed from, used to pick the tick rate of components
+// with a TickLOD. Set by the scene before every update.
+struct TickContext {
+    Vec3 viewer { 0.0f };
+    Frustum view {};
+    bool has_view { false };
+};
+
+
+struct ComponentPoolBase {
+    UpdatePhase update_phase { UpdatePhase::PrePhysics };
+    int update_order { 0 };
+    bool thread_safe { false };
+
+    // Updates the components in [p_begin, p_end) of the dense list.
+    virtual void update(double p_delta, size_t p_begin, size_t p_end) = 0;
+    virtual void draw(const Mat4& p_transform, DrawContext& p_context) = 0;
+    virtual size_t size() const = 0;
+
+    // Frees the pool's chunks if it holds no components, returns the number
+    // of chunks freed.
+    virtual size_t release_unused() = 0;
+
+    virtual ~ComponentPoolBase() {}
+
+    // --- Counters across all pools ---
+    inline static size_t chunk_allocations { 0 };
+    inline static size_t chunk_releases { 0 };
+    inline static std::atomic<size_t> skipped_ticks { 0 };
+
+    inline static TickContext tick_context;
+
+    inline static std::vector<ComponentPoolBase*> all_pools;
+
+    static size_t release_all_unused() {
+        size_t released = 0;
+        for (auto pool : all_pools) {
+            released += pool->release_unused();
+        }
+        return released;
+    }
+
+    // Pools whose type overrides the respective hook, sorted by update order.
+    // Update pools are additionally bucketed by phase.
+    inline static std::vector<ComponentPoolBase*> update_pools[UPDATE_PHASE_COUNT];
+    inline static std::vector<ComponentPoolBase*> draw_pools;
+
+protected:
+    static void register_pool(std::vector<ComponentPoolBase*>& p_pools, ComponentPoolBase* p_pool) {
+        auto position = std::upper_bound(p_pools.begin(), p_pools.end(), p_pool,
+            [](ComponentPoolBase* a, ComponentPoolBase* b) { return a->update_order < b->update_order; }
+        );
+        p_pools.insert(position, p_pool);
+    }
+};
+
+
+// Storage for all components of one concrete type. Components are
+// constructed in fixed size chunks, so their addresses stay stable while the
+// pool grows, and the pool keeps a dense list of live components to loop over.
+template<typename T>
+struct ComponentPool : public ComponentPoolBase {
+    static constexpr size_t CHUNK_SIZE = 256;
+
+    std::vector<T*> components;
+
+    static ComponentPool<T>& get() {
+        // Never freed, so components released during static destruction can
+        // still give their slot back.
+        static ComponentPool<T>* pool = new ComponentPool<T>();
+        return *pool;
+    }
+
+    template<typename... Ts>
+    Ref<T> create(Ts... p_arguments) {
+        if (free_slots.empty()) {
+            allocate_chunk();
+        }
+        T* slot = free_slots.back();
+        free_slots.pop_back();
+
+        T* component = new (slot) T(p_arguments...);
+        component->pool_index = uint32_t(components.size());
+        components.push_back(component);
+        if constexpr (HAS_TICK_LOD) {
+            // Staggered first interval, so components created together
+            // don't all tick on the same frames.
+            tick_states.push_back(TickState { .interval = 1 + component->pool_index % T::tick_lod.max_interval });
+        }
+        // The control block comes from the slab pools as well.
+        return Ref<T>(component, [](T* p_component) {
+            ComponentPool<T>::get().destroy(p_component);
+        }, SlabAllocator<T>());
+    }
+
+    // Components must not be destroyed while their pool is being iterated.
+    void destroy(T* p_component) {
+        const uint32_t index = p_component->pool_index;
+        components[index] = components.back();
+        components[index]->pool_index = index;
+        components.pop_back();
+        if constexpr (HAS_TICK_LOD) {
+            tick_states[index] = tick_states.back();
+            tick_states.pop_back();
+        }
+
+        p_component->~T();
+        free_slots.push_back(p_component);
+    }
+
+    template<typename F>
+    void for_each(F p_function) {
+        for (size_t index = 0; index < components.size(); index++) {
+            T* component = components[index];
+            if (component->node->is_active_in_tree()) {
+                p_function(*component);
+            }
+        }
+    }
+
+    void update(double p_delta, size_t p_begin, size_t p_end) override {
+        if constexpr (overrides_update<T>) {
+            size_t skipped = 0;
+            // Indexed loop, since updates may add components of the same type.
+            for (size_t index = p_begin; index < p_end && index < components.size(); index++) {
+                T* component = components[index];
+                if (!component->node->is_active_in_tree()) continue;
+
+                if constexpr (HAS_TICK_LOD) {
+                    TickState& state = tick_states[index];
+                    state.accumulated_delta += p_delta;
+                    state.frames_since_tick += 1;
+                    // The interval is only re-evaluated once the current one
+                    // is up, so a skipped frame costs no more than this.
+                    if (state.frames_since_tick >= state.interval) {
+                        state.interval = get_tick_interval(*component);
+                    }
+                    if (state.frames_since_tick < state.interval) {
+                        skipped += 1;
+                        continue;
+                    }
+                    const double delta = state.accumulated_delta;
+                    state.accumulated_delta = 0.0;
+                    state.frames_since_tick = 0;
+                    component->T::update(delta);
+                } else {
+                    component->T::update(p_delta);
+                }
+            }
+            if (skipped > 0) {
+                skipped_ticks += skipped;
+            }
+        }
+    }
+
+    void draw(const Mat4& p_transform, DrawContext& p_context) override {
+        if constexpr (overrides_draw<T>) {
+            for (T* component : components) {
+                if (component->node->is_visible_in_tree()) {
+                    component->T::draw(p_transform, p_context);
+                }
+            }
+        }
+    }
+
+    size_t size() const override {
+        return components.size();
+    }
+
+    size_t release_unused() override {
+        if (!components.empty()) {
+            return 0;
+        }
+        const size_t released = chunks.size();
+        chunks.clear();
+        free_slots.clear();
+        chunk_releases += released;
+        return released;
+    }
+
+private:
+    static constexpr bool HAS_TICK_LOD = T::tick_lod.max_interval > 1;
+
+    struct TickState {
+        double accumulated_delta { 0.0 };
+        uint32_t frames_since_tick { 0 };
+        uint32_t interval { 1 };
+    };
+    // Parallel to components, only used by types with a TickLOD.
+    std::vector<TickState> tick_states;
+
+    static uint32_t get_tick_interval(const T& p_component) {
+        constexpr TickLOD lod = T::tick_lod;
+        const Vec3 position = p_component.node->get_global_transform().position;
+        const float distance = glm::length(position - tick_context.viewer);
+
+        uint32_t interval = 1;
+        if (distance > lod.full_rate_distance) {
+            interval += uint32_t((distance - lod.full_rate_distance) / lod.distance_step);
+        }
+        if (tick_context.has_view && !tick_context.view.overlaps(AABB { position - Vec3(lod.radius), position + Vec3(lod.radius) })) {
+            interval = std::max(interval, lod.hidden_interval);
+        }
+        return std::min(interval, lod.max_interval);
+    }
+
+    struct Chunk {
+        alignas(T) std::byte data[CHUNK_SIZE * sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    std::vector<T*> free_slots;
+
+    void allocate_chunk() {
+        chunks.push_back(std::make_unique<Chunk>());
+        chunk_allocations += 1;
+        T* first = reinterpret_cast<T*>(chunks.back()->data);
+        // Reverse order, so slots are handed out front to back.
+        for (size_t index = CHUNK_SIZE; index-- > 0;) {
+            free_slots.push_back(first + index);
+        }
+    }
+
+    ComponentPool() {
+        all_pools.push_back(this);
+        update_phase = T::update_phase;
+        update_order = T::update_order;
+        thread_safe  = T::thread_safe;
+        if constexpr (overrides_update<T>) {
+            register_pool(update_pools[uint32_t(update_phase)], this);
+        }
+        if constexpr (overrides_draw<T>) {
+            register_pool(draw_pools, this);
+        }
+    }
+};
@@ -0,0 +1,112 @@
+#include <core/mapped_file.h>
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& p_other) noexcept {
+    *this = std::move(p_other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& p_other) noexcept {
+    if (this != &p_other) {
+        close();
+        address = std::exchange(p_other.address, nullptr);
+        length = std::exchange(p_other.length, 0);
+#ifdef _WIN32
+        file_handle = std::exchange(p_other.file_handle, nullptr);
+        mapping_handle = std::exchange(p_other.mapping_handle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& p_path) {
+    close();
+    HANDLE file = CreateFileA(p_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+    address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (address == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    length = size_t(file_size.QuadPart);
+    file_handle = file;
+    mapping_handle = mapping;
+    return true;
+}
+
+void MappedFile::close() {
+    if (address != nullptr) {
+        UnmapViewOfFile(address);
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+    }
+    address = nullptr;
+    length = 0;
+    file_handle = mapping_handle = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& p_path) {
+    close();
+    const int file = ::open(p_path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(file, &file_stat) != 0 || file_stat.st_size == 0) {
+        ::close(file);
+        return false;
+    }
+    void* mapped = mmap(nullptr, size_t(file_stat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping stays valid without the descriptor.
+    ::close(file);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    // Mesh data is read front to back, once.
+    madvise(mapped, size_t(file_stat.st_size), MADV_SEQUENTIAL);
+    address = mapped;
+    length = size_t(file_stat.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (address != nullptr) {
+        munmap(address, length);
+    }
+    address = nullptr;
+    length = 0;
+}
+
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. Pages are read in by the OS as
+// they are touched, nothing is copied to the heap.
+struct MappedFile {
+    MappedFile() = default;
+    MappedFile(MappedFile&& p_other) noexcept;
+    MappedFile& operator=(MappedFile&& p_other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    bool open(const std::string& p_path);
+    void close();
+
+    const char* data() const { return static_cast<const char*>(address); }
+    size_t size() const { return length; }
+    bool is_open() const { return address != nullptr; }
+
+private:
+    void* address { nullptr };
+    size_t length { 0 };
+#ifdef _WIN32
+    void* file_handle { nullptr };
+    void* mapping_handle { nullptr };
+#endif
+};
@@ -1,126 +1,168 @@
 #include <core/node.h>
+#include <core/transform_store.h>
 
-void Node::refresh_transform() {
-    refresh_transform(parent.lock() == nullptr ? Transform() : parent.lock()->global_transform);
-}
-
-void Node::refresh_transform(Transform p_parent_transform) {
-    // TODO: Why can't p_parent_transform be const?
-    global_transform = p_parent_transform * transform;
-
-    for (auto child : children) {
-        child->refresh_transform(global_transform);
-    }
-}
+extern TransformStore gTransforms;
+extern NodeRegistry gNodes;
 
-void Node::update(double delta) {
-    if (!active) return;
+void Node::cleanup() {
     for (auto& component : components) {
-        component->update(delta);
+        component->cleanup();
     }
     for (auto& child : children) {
-        child->update(delta);
+        child->cleanup();
     }
 }
 
-void Node::process_input(SDL_Event& event) {
-    if (!active) return;
-    for (auto& component : components) {
-        component->process_input(event);
-    }
-    for (auto& child : children) {
-        child->process_input(event);
+void Node::add_child(Ref<Node> p_child) {
+    if (p_child->parent != nullptr) {
+        p_child->parent->remove_child(p_child.get());
     }
+    p_child->child_index = uint32_t(children.size());
+    p_child->parent = this;
+    children.push_back(std::move(p_child));
+
+    Node* child = children.back().get();
+    gTransforms.set_parent(child->transform_id, transform_id);
+    child->refresh_tree_flags();
 }
 
-void Node::draw(const Mat4& p_transform, DrawContext& p_context) const {    
-    if (!visible) return;
-    for (auto& component : components) {
-        component->draw(p_transform, p_context);
+Ref<Node> Node::remove_child(Node* p_child) {
+    if (p_child == nullptr || p_child->parent != this) {
+        return nullptr;
     }
-    for (auto child : children) {
-        child->draw(p_transform, p_context);
+
+    const uint32_t index = p_child->child_index;
+    Ref<Node> removed = std::move(children[index]);
+    if (index + 1 < children.size()) {
+        children[index] = std::move(children.back());
+        children[index]->child_index = index;
     }
+    children.pop_back();
+
+    removed->parent = nullptr;
+    gTransforms.set_parent(removed->transform_id, TransformStore::INVALID_INDEX);
+    removed->refresh_tree_flags();
+    return removed;
 }
 
-void Node::cleanup() {
-    for (auto& component : components) {
-        component->cleanup();
+void Node::reparent(Node* p_new_parent) {
+    // A node can't become a child of its own subtree.
+    for (Node* ancestor = p_new_parent; ancestor != nullptr; ancestor = ancestor->parent) {
+        if (ancestor == this) return;
     }
-    for (auto child : children) {
-        child->cleanup();
+
+    Ref<Node> self = (parent != nullptr) ? parent->remove_child(this) : shared_from_this();
+    if (p_new_parent != nullptr) {
+        p_new_parent->add_child(std::move(self));
     }
 }
 
-void Node::add_child(Ref<Node> p_child) {
-    children.push_back(p_child);
-    p_child->parent = std::make_shared<Node>(*this);
+void Node::set_active(bool p_active) {
+    active = p_active;
+    refresh_tree_flags();
+}
+
+void Node::set_visible(bool p_visible) {
+    visible = p_visible;
+    refresh_tree_flags();
 }
 
-Node::Node(std::string p_name) {
+void Node::refresh_tree_flags() {
+    active_in_tree  = active  && (parent == nullptr || parent->active_in_tree);
+    visible_in_tree = visible && (parent == nullptr || parent->visible_in_tree);
+    for (auto& child : children) {
+        child->refresh_tree_flags();
+    }
+}
+
+Node::Node() {
+    transform_id = gTransforms.allocate();
+    handle = gNodes.add(this);
+}
+
+Node::Node(std::string p_name) : Node() {
     name = p_name;
 }
 
+Node::~Node() {
+    // Detach surviving children so they don't end up under whichever node
+    // reuses this transform id.
+    for (auto& child : children) {
+        child->parent = nullptr;
+        gTransforms.set_parent(child->transform_id, TransformStore::INVALID_INDEX);
+    }
+    gTransforms.release(transform_id);
+    gNodes.remove(handle);
+}
+
 Vec3 Node::get_position() const {
-    return transform.position;
+    return gTransforms.positions[gTransforms.index(transform_id)];
 }
 
 void Node::set_position(Vec3 p_position) {
-    transform.position = p_position;
-    refresh_transform();
+    gTransforms.positions[gTransforms.index(transform_id)] = p_position;
+    gTransforms.set_dirty(transform_id);
 }
 
 void Node::set_position(float p_x, float p_y, float p_z) {
-    transform.position = Vec3(p_x, p_y, p_z);
-    refresh_transform();
+    gTransforms.positions[gTransforms.index(transform_id)] = Vec3(p_x, p_y, p_z);
+    gTransforms.set_dirty(transform_id);
 }
 
 void Node::move(Vec3 p_vector) {
-    transform.position += p_vector;
-    refresh_transform();
+    gTransforms.positions[gTransforms.index(transform_id)] += p_vector;
+    gTransforms.set_dirty(transform_id);
 }
 
 void Node::move(float p_x, float p_y, float p_z) {
-    transform.position += Vec3(p_x, p_y, p_z);;
-    refresh_transform();
+    gTransforms.positions[gTransforms.index(transform_id)] += Vec3(p_x, p_y, p_z);
+    gTransforms.set_dirty(transform_id);
 }
 
 float Node::get_scale() const {
-    return transform.scale;
+    return gTransforms.scales[gTransforms.index(transform_id)];
 }
 
 void Node::set_scale(float p_scale) {
-    transform.scale = p_scale;
-    refresh_transform();
+    gTransforms.scales[gTransforms.index(transform_id)] = p_scale;
+    gTransforms.set_dirty(transform_id);
 }
 
 void Node::scale_by(float p_scale) {
-    transform.scale *= p_scale;
-    refresh_transform();
+    gTransforms.scales[gTransforms.index(transform_id)] *= p_scale;
+    gTransforms.set_dirty(transform_id);
 }
 
 glm::quat Node::get_rotation() const {
-    return transform.rotation;
+    return gTransforms.rotations[gTransforms.index(transform_id)];
 }
 
 void Node::set_rotation(glm::quat p_rotation) {
-    transform.rotation = p_rotation;
-    refresh_transform();
+    gTransforms.rotations[gTransforms.index(transform_id)] = p_rotation;
+    gTransforms.set_dirty(transform_id);
 }
 
 void Node::rotate(Vec3 p_axis, float p_angle) {
-    transform.rotation *= glm::quat(p_axis * p_angle);
-    refresh_transform();
+    gTransforms.rotations[gTransforms.index(transform_id)] *= glm::quat(p_axis * p_angle);
+    gTransforms.set_dirty(transform_id);
 }
 
 Transform Node::get_global_transform() const {
-    return global_transform;
+    return gTransforms.get_global_transform(transform_id);
+}
+
+const Mat4& Node::get_world_matrix() const {
+    return gTransforms.get_world_matrix(transform_id);
+}
+
+uint32_t Node::get_transform_stamp() const {
+    return gTransforms.get_change_stamp(transform_id);
 }
 
 Ref<Node> Node::create() {
-    return std::make_shared<Node>();
+    return std::allocate_shared<Node>(SlabAllocator<Node>());
 }
 
 Ref<Node> Node::create(std::string p_name) {
-    return std::make_shared<Node>(p_name);
+    return std::allocate_shared<Node>(SlabAllocator<Node>(), p_name);
 }
\ No newline at end of file
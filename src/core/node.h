@@ -1,27 +1,67 @@
 #pragma once
 #include <math.h>
 #include <core/component.h>
+#include <core/component_pool.h>
+#include <core/node_registry.h>
 #include <type_traits>
+#include <bit>
+#include <memory>
 #include <util.h>
 
 union SDL_Event;
 
-struct Node {
+struct Node : public std::enable_shared_from_this<Node> {
 protected:
-    Transform transform {};
-    Transform global_transform {};
-    // TODO: flag to only recalculate global transform when necessary
+    // Local and global transforms live in gTransforms under this id.
+    uint32_t transform_id;
 
-    std::unordered_map<const std::type_info*, Ref<Component>> component_table;
+    NodeHandle handle;
+    // Position in the parent's children, for constant time removal.
+    uint32_t child_index { 0 };
+
+    // Bit i is set if the node has a component with ComponentType id i. The
+    // slots hold one component per set bit, ordered by type id, so the slot
+    // of a type is the number of set bits below it.
+    uint64_t component_mask { 0 };
+    std::vector<Component*> component_slots;
+
+    template<typename T>
+    uint64_t component_bit() const {
+        return uint64_t(1) << ComponentType::id<T>();
+    }
+
+    template<typename T>
+    uint32_t component_slot() const {
+        return std::popcount(component_mask & (component_bit<T>() - 1));
+    }
+
+    bool active  { true };
+    bool visible { true };
+
+    // Whether this node and all of its ancestors are active/visible, kept up
+    // to date on change so component pools can check it per component.
+    bool active_in_tree  { true };
+    bool visible_in_tree { true };
+
+    void refresh_tree_flags();
 
 public:
     std::string name {"New node"};
-    std::weak_ptr<Node> parent;
+    // Non-owning, the parent owns its children through the children array.
+    Node* parent { nullptr };
     std::vector<Ref<Node>> children;
 
+    NodeHandle get_handle() const { return handle; }
+
     std::vector<Ref<Component>> components;
-    bool active  { true };
-    bool visible { true };
+
+    bool is_active() const { return active; }
+    void set_active(bool p_active);
+    bool is_active_in_tree() const { return active_in_tree; }
+
+    bool is_visible() const { return visible; }
+    void set_visible(bool p_visible);
+    bool is_visible_in_tree() const { return visible_in_tree; }
 
     Vec3 get_position() const;
     void set_position(Vec3 p_position);
@@ -39,45 +79,96 @@ public:
     void rotate(Vec3 p_axis, float p_angle);
 
     Transform get_global_transform() const;
+    const Mat4& get_world_matrix() const;
+    // Changes whenever the global transform may have changed.
+    uint32_t get_transform_stamp() const;
 
+    // Attaching a node that already has a parent moves it over. Removing a
+    // child moves the last child into its place, so sibling order is not
+    // preserved.
     void add_child(Ref<Node> p_child);
+    Ref<Node> remove_child(Node* p_child);
+    void reparent(Node* p_new_parent);
 
-    template<typename T>
-    std::enable_if_t<std::is_base_of_v<Component, T>, void>
-    add_component(Ref<T> p_component) {
-        p_component->node = this;
-        components.push_back(p_component);
-        component_table[&typeid(T)] = p_component;
-    }
-    
     template<typename T, typename... Ts>
     std::enable_if_t<std::is_base_of_v<Component, T>, Ref<T>>
     add_component(Ts... arguments) {
-        auto component = std::make_shared<T>(arguments...);
+        auto component = ComponentPool<T>::get().create(arguments...);
         component->node = this;
         components.push_back(component);
 
-        component_table[&typeid(T)] = component;
+        // A second component of the same type replaces the first in lookups.
+        if (component_mask & component_bit<T>()) {
+            component_slots[component_slot<T>()] = component.get();
+        } else {
+            component_slots.insert(component_slots.begin() + component_slot<T>(), component.get());
+            component_mask |= component_bit<T>();
+        }
         return component;
     }
 
+    // Non-owning lookup of a component the node is known to have.
     template<typename T>
-    std::enable_if_t<std::is_base_of_v<Component, T>, Ref<T>>
-    get_component() {
-        return static_pointer_cast<T>(component_table[&typeid(T)]);
+    std::enable_if_t<std::is_base_of_v<Component, T>, T*>
+    get_component() const {
+        assert(has_component<T>());
+        return static_cast<T*>(component_slots[component_slot<T>()]);
     }
 
-    void refresh_transform();
-    void refresh_transform(Transform p_parent_transform);
+    // Returns nullptr if the node has no component of type T.
+    template<typename T>
+    std::enable_if_t<std::is_base_of_v<Component, T>, T*>
+    try_get_component() const {
+        if (!has_component<T>()) {
+            return nullptr;
+        }
+        return static_cast<T*>(component_slots[component_slot<T>()]);
+    }
+
+    template<typename T>
+    bool has_component() const {
+        return (component_mask & component_bit<T>()) != 0;
+    }
+
+    // Cleans up and releases the component returned by get_component<T>().
+    // Must not be called while the pool of T is being updated, see
+    // SceneCommandBuffer for deferring it.
+    template<typename T>
+    std::enable_if_t<std::is_base_of_v<Component, T>, void>
+    remove_component() {
+        if (!has_component<T>()) return;
+
+        const uint32_t slot = component_slot<T>();
+        Component* removed = component_slots[slot];
+        removed->cleanup();
+
+        // Fall back to an older component of the same type, if there is one.
+        Component* replacement = nullptr;
+        for (auto& component : components) {
+            if (component.get() != removed && typeid(*component) == typeid(T)) {
+                replacement = component.get();
+            }
+        }
+        if (replacement != nullptr) {
+            component_slots[slot] = replacement;
+        } else {
+            component_slots.erase(component_slots.begin() + slot);
+            component_mask &= ~component_bit<T>();
+        }
+
+        std::erase_if(components, [removed](const Ref<Component>& p_component) {
+            return p_component.get() == removed;
+        });
+    }
 
-    void update(double delta);
-    void process_input(SDL_Event& event);
-    void draw(const Mat4& p_transform, DrawContext& p_context) const;
     void cleanup();
 
     static Ref<Node> create();
     static Ref<Node> create(std::string p_name);
 
-    Node() {};
+    Node();
     Node(std::string p_name);
+    Node(const Node&) = delete;
+    Node& operator=(const Node&) = delete;
+    ~Node();
 };
\ No newline at end of file
@@ -0,0 +1,24 @@
+#include <core/node_registry.h>
+
+NodeHandle NodeRegistry::add(Node* p_node) {
+    uint32_t index;
+    if (free_indices.empty()) {
+        index = uint32_t(nodes.size());
+        nodes.push_back(nullptr);
+        generations.push_back(0);
+    } else {
+        index = free_indices.back();
+        free_indices.pop_back();
+    }
+    nodes[index] = p_node;
+    return NodeHandle { .index = index, .generation = generations[index] };
+}
+
+void NodeRegistry::remove(NodeHandle p_handle) {
+    if (get(p_handle) == nullptr) {
+        return;
+    }
+    nodes[p_handle.index] = nullptr;
+    generations[p_handle.index] += 1;
+    free_indices.push_back(p_handle.index);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Node;
+
+// Weak reference to a node. The generation is bumped whenever a registry
+// slot is reused, so a handle to a destroyed node resolves to nullptr instead
+// of to whichever node took its place.
+struct NodeHandle {
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    uint32_t index { INVALID_INDEX };
+    uint32_t generation { 0 };
+
+    bool operator==(const NodeHandle& p_other) const = default;
+};
+
+struct NodeRegistry {
+    NodeHandle add(Node* p_node);
+    void remove(NodeHandle p_handle);
+
+    // Returns nullptr for invalid or stale handles.
+    Node* get(NodeHandle p_handle) const {
+        if (p_handle.index >= nodes.size() || generations[p_handle.index] != p_handle.generation) {
+            return nullptr;
+        }
+        return nodes[p_handle.index];
+    }
+
+    size_t size() const {
+        return nodes.size() - free_indices.size();
+    }
+
+private:
+    std::vector<Node*> nodes;
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> free_indices;
+};
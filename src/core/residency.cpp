@@ -0,0 +1,65 @@
+#include <core/residency.h>
+
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+
+namespace {
+    struct Entry {
+        const void* resource;
+        size_t gpu_size;
+        size_t cpu_size;
+        std::function<void()> release;
+    };
+
+    // Most recently retired first.
+    std::list<Entry> entries;
+    std::unordered_map<const void*, std::list<Entry>::iterator> lookup;
+
+    void evict_oldest() {
+        Entry entry = std::move(entries.back());
+        entries.pop_back();
+        lookup.erase(entry.resource);
+        Residency::cached_count -= 1;
+        Residency::cached_gpu_size -= entry.gpu_size;
+        Residency::cached_cpu_size -= entry.cpu_size;
+        Residency::evictions += 1;
+        entry.release();
+    }
+}
+
+void Residency::retire(const void* p_resource, size_t p_gpu_size, size_t p_cpu_size, std::function<void()> p_release) {
+    entries.push_front(Entry { p_resource, p_gpu_size, p_cpu_size, std::move(p_release) });
+    lookup[p_resource] = entries.begin();
+    cached_count += 1;
+    cached_gpu_size += p_gpu_size;
+    cached_cpu_size += p_cpu_size;
+}
+
+void Residency::revive(const void* p_resource) {
+    auto found = lookup.find(p_resource);
+    if (found == lookup.end()) return;
+    cached_count -= 1;
+    cached_gpu_size -= found->second->gpu_size;
+    cached_cpu_size -= found->second->cpu_size;
+    entries.erase(found->second);
+    lookup.erase(found);
+}
+
+void Residency::update(MemoryBudget p_gpu_memory) {
+    gpu_memory = p_gpu_memory;
+    effective_gpu_budget = (gpu_budget != 0) ? gpu_budget : size_t(double(p_gpu_memory.budget) * GPU_BUDGET_SHARE);
+
+    // The reported usage lags behind frees, so it is corrected by hand.
+    size_t gpu_usage = p_gpu_memory.usage;
+    while (!entries.empty() && (gpu_usage > effective_gpu_budget || cached_cpu_size > cpu_budget)) {
+        gpu_usage -= std::min(gpu_usage, entries.back().gpu_size);
+        evict_oldest();
+    }
+}
+
+void Residency::clear() {
+    while (!entries.empty()) {
+        evict_oldest();
+    }
+}
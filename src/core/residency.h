@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+struct MemoryBudget {
+    size_t usage { 0 };
+    size_t budget { 0 };
+};
+
+// Keeps loaded resources around after their last reference is dropped, so
+// loading them again is free. They are kept in least recently used order and
+// only released once memory runs over budget. Main thread only.
+struct Residency {
+    // Share of the GPU memory the driver reports as available that may be
+    // used before cached resources are evicted, unless gpu_budget is set.
+    static constexpr float GPU_BUDGET_SHARE = 0.8f;
+
+    // In bytes, 0 for the share above.
+    inline static size_t gpu_budget { 0 };
+    // Memory cached resources may hold on the CPU, in bytes.
+    inline static size_t cpu_budget { 256ull * 1024 * 1024 };
+
+    // Takes an unreferenced resource. p_release is called when it gets
+    // evicted, identified by p_resource.
+    static void retire(const void* p_resource, size_t p_gpu_size, size_t p_cpu_size, std::function<void()> p_release);
+
+    // Takes a resource back that was referenced again before it got evicted.
+    static void revive(const void* p_resource);
+
+    // Evicts the least recently used resources while over budget. Called once
+    // per frame with the GPU heaps' state.
+    static void update(MemoryBudget p_gpu_memory);
+
+    // Evicts everything.
+    static void clear();
+
+    // --- Statistics ---
+    inline static size_t cached_count { 0 };
+    inline static size_t cached_gpu_size { 0 };
+    inline static size_t cached_cpu_size { 0 };
+    inline static size_t evictions { 0 };
+    inline static MemoryBudget gpu_memory {};
+    inline static size_t effective_gpu_budget { 0 };
+};
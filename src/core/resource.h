@@ -1,9 +1,12 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 #include <string>
 #include <print>
+#include <core/residency.h>
+#include <core/resource_id.h>
 
 enum class LoadStatus {
     UNLOADED,
@@ -16,31 +19,88 @@ struct Resource {
 private:
     T* pointer;
     uint reference_count {0};
-    LoadStatus load_status { LoadStatus::UNLOADED };
+    // Written by loader threads, read by the main thread.
+    std::atomic<LoadStatus> load_status { LoadStatus::UNLOADED };
+    // Set while a loader thread may still write to the resource, which the
+    // loader's own status updates can't tell, and if the last reference was
+    // dropped in the meantime.
+    bool loading_async { false };
+    bool orphaned { false };
+    // Unreferenced, but kept loaded by the residency cache.
+    bool cached { false };
+
+    void release() {
+        // Fetched but never loaded, there is nothing to unload.
+        if (load_status != LoadStatus::UNLOADED) {
+            unload();
+        }
+        delete pointer;
+        // A fresh value, so the resource can be loaded again.
+        pointer = new T;
+        load_status = LoadStatus::UNLOADED;
+    }
+
+    void retire() {
+        if (!loaded()) {
+            release();
+            return;
+        }
+        cached = true;
+        Residency::retire(this, get_gpu_size(), get_cpu_size(), [this]() {
+            cached = false;
+            release();
+        });
+    }
 
 public:
-    std::string guid {"<invalid resource>"};
+    ResourceID id;
 
     void reference() {
+        if (cached) {
+            Residency::revive(this);
+            cached = false;
+        }
         reference_count += 1;
-        // std::println("REFERENCE+: {}, {}", reference_count, guid);
+        // std::println("REFERENCE+: {}, {}", reference_count, id.get_name());
     }
 
     void unreference() {
         reference_count -= 1;
-        // std::println("REFERENCE-: {}, {}", reference_count, guid);
+        // std::println("REFERENCE-: {}, {}", reference_count, id.get_name());
         if (reference_count == 0) {
-            unload();
-            delete pointer;
-            pointer = nullptr;
-            load_status = LoadStatus::UNLOADED;
+            if (loading_async) {
+                orphaned = true;
+                return;
+            }
+            retire();
         }
     }
 
+    void begin_loading() {
+        loading_async = true;
+        load_status = LoadStatus::LOADING;
+    }
+
+    // Called on the main thread once an asynchronous load is done. Returns
+    // false if the resource was given up while loading, it goes straight to
+    // the residency cache then.
+    bool finish_loading() {
+        loading_async = false;
+        load_status = LoadStatus::LOADED;
+        if (orphaned) {
+            orphaned = false;
+            if (reference_count == 0) {
+                retire();
+                return false;
+            }
+        }
+        return true;
+    }
+
     void operator=(const Resource<T>& p_resource) {
         pointer = p_resource.pointer;
-        load_status = p_resource.load_status;
-        guid = p_resource.guid;
+        load_status = p_resource.load_status.load();
+        id = p_resource.id;
         reference_count = p_resource.reference_count;
     }
 
@@ -56,8 +116,8 @@ public:
         pointer = new T;
     }
 
-    Resource(std::string p_guid) {
-        guid = p_guid;
+    Resource(ResourceID p_id) {
+        id = p_id;
         pointer = new T;
     }
 
@@ -71,8 +131,8 @@ public:
 
     Resource(const Resource<T>& p_resource) {
         pointer = p_resource.pointer;
-        load_status = p_resource.load_status;
-        guid = p_resource.guid;
+        load_status = p_resource.load_status.load();
+        id = p_resource.id;
         reference_count = p_resource.reference_count;
     }
 
@@ -80,6 +140,10 @@ public:
         return (load_status == LoadStatus::LOADED);
     }
 
+    LoadStatus get_load_status() const {
+        return load_status;
+    }
+
     void set_load_status(LoadStatus p_load_status) {
         load_status = p_load_status;
     }
@@ -87,4 +151,9 @@ public:
     template<typename... Ts>
     static Resource<T>& load(std::string p_guid, Ts... arguments);
     void unload() {};
+
+    // Memory a loaded resource holds, for the residency budgets. Types that
+    // hold any specialize these.
+    size_t get_gpu_size() const { return 0; }
+    size_t get_cpu_size() const { return 0; }
 };
\ No newline at end of file
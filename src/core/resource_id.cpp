@@ -0,0 +1,72 @@
+#include <core/resource_id.h>
+
+#include <util.h>
+
+#include <charconv>
+#include <format>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+    std::mutex names_mutex;
+
+    // Only used for diagnostics and collision checks, never for lookups.
+    // Local, so ids can be interned during static initialization.
+    std::unordered_map<ResourceID, std::string>& get_names() {
+        static std::unordered_map<ResourceID, std::string> names;
+        return names;
+    }
+}
+
+ResourceID ResourceID::intern(std::string_view p_name) {
+    const ResourceID id = from_name(p_name);
+    register_name(id, p_name);
+    return id;
+}
+
+void ResourceID::register_name(ResourceID p_id, std::string_view p_name) {
+    std::lock_guard lock(names_mutex);
+    auto [entry, inserted] = get_names().try_emplace(p_id, p_name);
+    if (!inserted && entry->second != p_name) {
+        print("Resource id collision: \"%s\" and \"%s\" both hash to %s", entry->second.c_str(), std::string(p_name).c_str(), p_id.to_string().c_str());
+    }
+}
+
+ResourceID ResourceID::from_bytes(const void* p_data, size_t p_size, ResourceID p_seed) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(p_data);
+    uint64_t hash = p_seed.value;
+    for (size_t index = 0; index < p_size; index++) {
+        hash ^= bytes[index];
+        hash *= 0x100000001b3ull;
+    }
+    return ResourceID(hash);
+}
+
+std::string ResourceID::get_name() const {
+    {
+        std::lock_guard lock(names_mutex);
+        auto& names = get_names();
+        auto entry = names.find(*this);
+        if (entry != names.end()) {
+            return entry->second;
+        }
+    }
+    return to_string();
+}
+
+std::string ResourceID::to_string() const {
+    return std::format("{:016x}", value);
+}
+
+bool ResourceID::parse(std::string_view p_text, ResourceID& r_id) {
+    if (p_text.size() != 16) {
+        return false;
+    }
+    uint64_t value;
+    auto [end, error] = std::from_chars(p_text.data(), p_text.data() + p_text.size(), value, 16);
+    if (error != std::errc() || end != p_text.data() + p_text.size()) {
+        return false;
+    }
+    r_id = ResourceID(value);
+    return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// 64-bit hash of a resource name, such as a file path or
+// "{imported file}::/meshes/x". Resources are looked up by id only, names
+// are hashed once, at import time where possible.
+struct ResourceID {
+    uint64_t value { 0 };
+
+    constexpr ResourceID() {}
+    constexpr explicit ResourceID(uint64_t p_value) : value(p_value) {}
+
+    // FNV-1a, usable at compile time. Doesn't register the name, see intern().
+    static constexpr ResourceID from_name(std::string_view p_name) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (char character : p_name) {
+            hash ^= uint8_t(character);
+            hash *= 0x100000001b3ull;
+        }
+        return ResourceID(hash);
+    }
+
+    // Content hash of p_size bytes. Several blocks are hashed as one by
+    // passing the id of the previous ones as p_seed.
+    static ResourceID from_bytes(const void* p_data, size_t p_size, ResourceID p_seed = from_name(""));
+
+    // Hashes p_name and remembers it for diagnostics. Reports an error if a
+    // different name was interned with the same id before.
+    static ResourceID intern(std::string_view p_name);
+
+    // Remembers p_name for an id that was read from disk.
+    static void register_name(ResourceID p_id, std::string_view p_name);
+
+    // Interned name for messages, the id in hex if there is none.
+    std::string get_name() const;
+
+    // 16 hex digits, as stored in imported files.
+    std::string to_string() const;
+    static bool parse(std::string_view p_text, ResourceID& r_id);
+
+    bool is_valid() const {
+        return value != 0;
+    }
+
+    bool operator==(const ResourceID&) const = default;
+};
+
+template<>
+struct std::hash<ResourceID> {
+    size_t operator()(ResourceID p_id) const noexcept {
+        // Already a good hash.
+        return size_t(p_id.value);
+    }
+};
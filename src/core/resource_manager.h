@@ -1,35 +1,177 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
 #include <util.h>
+#include <core/resource.h>
+#include <core/resource_id.h>
+#include <core/task.h>
 
 struct ResourceManager {
 private:
     template<typename T>
-    inline static std::unordered_map<std::string, Ref<Resource<T>>> resources;
+    inline static std::unordered_map<ResourceID, Ref<Resource<T>>> resources;
 
-public:
+    // Completion callbacks of the asynchronous loads in flight.
     template<typename T>
-    static Ref<Resource<T>> get(const char* p_guid) {
-        if (!resources<T>.contains(p_guid)) {
-            resources<T>[p_guid] = std::make_shared<Resource<T>>();
-            resources<T>[p_guid]->guid = p_guid;
+    inline static std::unordered_map<ResourceID, std::vector<std::function<void(Ref<Resource<T>>)>>> pending_callbacks;
+
+    // Guards the maps above.
+    inline static std::mutex mutex;
+    inline static std::atomic<size_t> loads_in_flight { 0 };
+
+    template<typename T>
+    static Ref<Resource<T>> get_locked(ResourceID p_id) {
+        auto& resource = resources<T>[p_id];
+        if (resource == nullptr) {
+            resource = std::make_shared<Resource<T>>(p_id);
         }
-        return resources<T>[p_guid];
+        return resource;
     }
 
     template<typename T>
-    static void set(const char* p_guid, T p_value) {
-        resources<T>[p_guid] = p_value;
+    static void finish_load(ResourceID p_id) {
+        Ref<Resource<T>> resource;
+        std::vector<std::function<void(Ref<Resource<T>>)>> callbacks;
+        {
+            std::lock_guard lock(mutex);
+            resource = resources<T>[p_id];
+            auto pending = pending_callbacks<T>.find(p_id);
+            if (pending != pending_callbacks<T>.end()) {
+                callbacks = std::move(pending->second);
+                pending_callbacks<T>.erase(pending);
+            }
+        }
+        loads_in_flight -= 1;
+        if (!resource->finish_loading()) {
+            return;
+        }
+        for (auto& callback : callbacks) {
+            callback(resource);
+        }
+    }
+
+    template<typename T, typename... Ts>
+    static prosper::Task<void> run_load(ResourceID p_id, std::string p_path, Ts... p_arguments) {
+        co_await load_steps<T>(p_id, p_path, p_arguments...);
+        co_await prosper::resume_on_main();
+        finish_load<T>(p_id);
     }
 
+public:
+    template<typename T>
+    static Ref<Resource<T>> get(ResourceID p_id) {
+        std::lock_guard lock(mutex);
+        return get_locked<T>(p_id);
+    }
+
+    template<typename T>
+    static void set(ResourceID p_id, T p_value) {
+        std::lock_guard lock(mutex);
+        resources<T>[p_id] = p_value;
+    }
+
+    // Loads on the calling thread and blocks until done. The resource is
+    // stored under p_id.
+    template<typename T, typename... Ts>
+    static Ref<Resource<T>> load(ResourceID p_id, const char* p_path, Ts... p_arguments);
+
+    // As above, stored under the interned path.
     template<typename T, typename... Ts>
-    static Ref<Resource<T>> load(const char* p_guid, Ts... p_arguments);
+    static Ref<Resource<T>> load(const char* p_path, Ts... p_arguments) {
+        return load<T>(ResourceID::intern(p_path), p_path, p_arguments...);
+    }
+
+    // Returns the resource right away and runs load_steps<T> in the
+    // background. The resource stays LOADING until the load is finished, then
+    // becomes LOADED and p_on_loaded is called on the main thread. A resource
+    // that is already loaded calls p_on_loaded immediately, and requests for
+    // one that is still loading join the load in flight.
+    template<typename T, typename... Ts>
+    static Ref<Resource<T>> load_async(ResourceID p_id, std::string p_path, std::function<void(Ref<Resource<T>>)> p_on_loaded, Ts... p_arguments) {
+        std::unique_lock lock(mutex);
+        Ref<Resource<T>> resource = get_locked<T>(p_id);
+        const LoadStatus status = resource->get_load_status();
+        if (status == LoadStatus::LOADED) {
+            lock.unlock();
+            if (p_on_loaded) {
+                p_on_loaded(resource);
+            }
+            return resource;
+        }
+
+        auto& callbacks = pending_callbacks<T>[p_id];
+        if (p_on_loaded) {
+            callbacks.push_back(std::move(p_on_loaded));
+        }
+        if (status == LoadStatus::LOADING) {
+            return resource;
+        }
+        resource->begin_loading();
+        lock.unlock();
+
+        loads_in_flight += 1;
+        run_load<T>(p_id, std::move(p_path), p_arguments...).start();
+        return resource;
+    }
+
+    // Awaitable form of load_async, resumes on the main thread with the
+    // loaded resource.
+    template<typename T, typename... Ts>
+    static prosper::Task<Ref<Resource<T>>> load_task(std::string p_path, Ts... p_arguments) {
+        struct Awaiter {
+            ResourceID id;
+            std::string path;
+            std::tuple<Ts...> arguments;
+            Ref<Resource<T>> result;
+            std::coroutine_handle<> handle;
+            // Whoever gets here second, the callback or await_suspend, is
+            // the one that continues the coroutine.
+            std::atomic<bool> arrived { false };
+
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> p_handle) {
+                handle = p_handle;
+                std::apply([this](auto... p_values) {
+                    load_async<T>(id, path, [this](Ref<Resource<T>> p_resource) {
+                        result = p_resource;
+                        if (arrived.exchange(true)) {
+                            handle.resume();
+                        }
+                    }, p_values...);
+                }, arguments);
+                return !arrived.exchange(true);
+            }
+            Ref<Resource<T>> await_resume() { return result; }
+        };
+        Awaiter awaiter { ResourceID::intern(p_path), p_path, std::make_tuple(p_arguments...) };
+        co_return co_await awaiter;
+    }
+
+    // The steps of an asynchronous load, ending on any thread once the
+    // resource is filled in. By default the blocking load<T> on a loader
+    // thread. Types that can do better, like splitting the load into file
+    // reads, decoding and GPU uploads, specialize this.
+    template<typename T, typename... Ts>
+    static prosper::Task<void> load_steps(ResourceID p_id, std::string p_path, Ts... p_arguments) {
+        co_await prosper::resume_on_worker();
+        load<T>(p_id, p_path.c_str(), p_arguments...);
+    }
+
+    // Number of asynchronous loads not yet finished.
+    static size_t get_pending_count() {
+        return loads_in_flight;
+    }
 
     template<typename T>
-    static void save(const char* p_guid);
+    static void save(ResourceID p_id);
 
     template<typename T>
-    static void unload(const char* p_guid);
-};
\ No newline at end of file
+    static void unload(ResourceID p_id);
+};
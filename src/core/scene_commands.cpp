@@ -0,0 +1,87 @@
+#include <core/scene_commands.h>
+#include <core/node.h>
+
+extern NodeRegistry gNodes;
+
+void SceneCommandBuffer::record(Command p_command) {
+    std::lock_guard lock(mutex);
+    commands.push_back(std::move(p_command));
+}
+
+void SceneCommandBuffer::spawn(NodeHandle p_parent, std::function<Ref<Node>()> p_create) {
+    record(Command { .type = CommandType::SPAWN, .target = p_parent, .create = std::move(p_create) });
+}
+
+void SceneCommandBuffer::destroy(NodeHandle p_node) {
+    record(Command { .type = CommandType::DESTROY, .node = p_node });
+}
+
+void SceneCommandBuffer::reparent(NodeHandle p_node, NodeHandle p_new_parent) {
+    record(Command { .type = CommandType::REPARENT, .node = p_node, .target = p_new_parent });
+}
+
+void SceneCommandBuffer::set_active(NodeHandle p_node, bool p_active) {
+    record(Command { .type = CommandType::SET_ACTIVE, .node = p_node, .flag = p_active });
+}
+
+void SceneCommandBuffer::set_visible(NodeHandle p_node, bool p_visible) {
+    record(Command { .type = CommandType::SET_VISIBLE, .node = p_node, .flag = p_visible });
+}
+
+size_t SceneCommandBuffer::size() {
+    std::lock_guard lock(mutex);
+    return commands.size();
+}
+
+void SceneCommandBuffer::apply() {
+    {
+        std::lock_guard lock(mutex);
+        applying.swap(commands);
+    }
+
+    // Commands recorded while applying end up in the next batch.
+    for (auto& command : applying) {
+        Node* node = gNodes.get(command.node);
+        switch (command.type) {
+            case CommandType::SPAWN: {
+                Node* parent = gNodes.get(command.target);
+                if (parent != nullptr) {
+                    parent->add_child(command.create());
+                }
+                break;
+            }
+            case CommandType::DESTROY:
+                if (node != nullptr) {
+                    node->cleanup();
+                    if (node->parent != nullptr) {
+                        node->parent->remove_child(node);
+                    }
+                }
+                break;
+            case CommandType::REPARENT: {
+                Node* new_parent = gNodes.get(command.target);
+                if (node != nullptr && new_parent != nullptr) {
+                    node->reparent(new_parent);
+                }
+                break;
+            }
+            case CommandType::SET_ACTIVE:
+                if (node != nullptr) {
+                    node->set_active(command.flag);
+                }
+                break;
+            case CommandType::SET_VISIBLE:
+                if (node != nullptr) {
+                    node->set_visible(command.flag);
+                }
+                break;
+            case CommandType::ADD_COMPONENT:
+            case CommandType::REMOVE_COMPONENT:
+                if (node != nullptr) {
+                    command.function(node);
+                }
+                break;
+        }
+    }
+    applying.clear();
+}
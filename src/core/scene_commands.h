@@ -0,0 +1,77 @@
+#pragma once
+
+#include <core/node.h>
+#include <core/node_registry.h>
+#include <util.h>
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Structural changes to the scene recorded while it is being updated and
+// applied together at a single point in the frame, so nothing mutates the
+// hierarchy or the component pools while they are iterated. Recording is
+// thread safe. Commands referring to nodes that are gone by the time they
+// are applied are dropped.
+struct SceneCommandBuffer {
+    // p_create runs when the buffer is applied, on the main thread.
+    void spawn(NodeHandle p_parent, std::function<Ref<Node>()> p_create);
+    void destroy(NodeHandle p_node);
+    void reparent(NodeHandle p_node, NodeHandle p_new_parent);
+    void set_active(NodeHandle p_node, bool p_active);
+    void set_visible(NodeHandle p_node, bool p_visible);
+
+    template<typename T, typename... Ts>
+    void add_component(NodeHandle p_node, Ts... p_arguments) {
+        record(Command {
+            .type = CommandType::ADD_COMPONENT,
+            .node = p_node,
+            .function = [p_arguments...](Node* p_target) {
+                p_target->add_component<T>(p_arguments...)->initialize();
+            },
+        });
+    }
+
+    template<typename T>
+    void remove_component(NodeHandle p_node) {
+        record(Command {
+            .type = CommandType::REMOVE_COMPONENT,
+            .node = p_node,
+            .function = [](Node* p_target) {
+                p_target->remove_component<T>();
+            },
+        });
+    }
+
+    // Applies all recorded commands in recording order. Called once per frame.
+    void apply();
+
+    size_t size();
+
+private:
+    enum class CommandType {
+        SPAWN,
+        DESTROY,
+        REPARENT,
+        SET_ACTIVE,
+        SET_VISIBLE,
+        ADD_COMPONENT,
+        REMOVE_COMPONENT,
+    };
+
+    struct Command {
+        CommandType type;
+        NodeHandle node {};
+        NodeHandle target {};
+        bool flag { false };
+        std::function<void(Node*)> function {};
+        std::function<Ref<Node>()> create {};
+    };
+
+    std::mutex mutex;
+    std::vector<Command> commands;
+    // Swapped with commands when applying, keeps its capacity between frames.
+    std::vector<Command> applying;
+
+    void record(Command p_command);
+};
@@ -1,11 +1,82 @@
 #include <core/scene_graph.h>
 #include <core/node.h>
 #include <components/camera.h>
+#include <components/collectible.h>
+#include <components/mesh_instance.h>
+#include <components/point_light.h>
 #include <rendering/types.h>
 
 void SceneGraph::update(double delta) {
+    if (camera != nullptr) {
+        ComponentPoolBase::tick_context = TickContext {
+            .viewer = camera->get_global_transform().position,
+            .view = view_frustum,
+            .has_view = has_view,
+        };
+    }
+    scheduler.run(delta);
+
     point_lights.clear();
-    root->update(delta);
+    for_each<PointLight>([this](PointLight& p_light) {
+        point_lights.emplace_back(
+            GPUPointLight {
+                .position = p_light.node->get_global_transform().position,
+                .intensity = p_light.intensity,
+                .color = p_light.color,
+            }
+        );
+    });
+}
+
+void SceneGraph::draw(DrawContext& p_context, const Frustum& p_frustum) {
+    const ComponentPoolBase* mesh_pool = &ComponentPool<MeshInstance>::get();
+    for (auto pool : ComponentPoolBase::draw_pools) {
+        if (pool != mesh_pool) {
+            pool->draw(Mat4(1.0f), p_context);
+        }
+    }
+
+    view_frustum = p_frustum;
+    has_view = true;
+
+    visible_proxies.clear();
+    spatial.query_frustum(p_frustum, SpatialCategory::MESH, visible_proxies);
+    visible_mesh_count = 0;
+    for (uint32_t proxy : visible_proxies) {
+        auto mesh_instance = static_cast<MeshInstance*>(spatial.get_user_data(proxy));
+        if (mesh_instance->node->is_visible_in_tree()) {
+            mesh_instance->draw(Mat4(1.0f), p_context);
+            visible_mesh_count += 1;
+        }
+    }
+}
+
+// Unchanged nodes cost a single stamp comparison, and moved ones only touch
+// the tree if they leave their fat bounds.
+template<typename T>
+static void update_proxies(SpatialIndex& p_index, uint32_t p_category) {
+    for (T* component : ComponentPool<T>::get().components) {
+        SpatialProxy& proxy = component->proxy;
+        if (proxy.index != nullptr && proxy.transform_stamp == component->node->get_transform_stamp()) {
+            continue;
+        }
+
+        const AABB bounds = component->get_bounds();
+        if (proxy.index == nullptr) {
+            proxy.index = &p_index;
+            proxy.id = p_index.create_proxy(bounds, p_category, component);
+        } else {
+            p_index.move_proxy(proxy.id, bounds);
+        }
+        // Read after computing the bounds, which may re-sort the transforms.
+        proxy.transform_stamp = component->node->get_transform_stamp();
+    }
+}
+
+void SceneGraph::update_spatial_index() {
+    update_proxies<MeshInstance>(spatial, SpatialCategory::MESH);
+    update_proxies<PointLight>(spatial, SpatialCategory::LIGHT);
+    update_proxies<Collectible>(spatial, SpatialCategory::TRIGGER);
 }
 
 void SceneGraph::cleanup() {
@@ -14,4 +85,9 @@ void SceneGraph::cleanup() {
     camera = nullptr;
     root->cleanup();
     root = nullptr;
-}
\ No newline at end of file
+
+    // Nodes and components of the scene are gone now, so their chunks can
+    // be handed back in bulk.
+    ComponentPoolBase::release_all_unused();
+    SlabPool::release_all_unused();
+}
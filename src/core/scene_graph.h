@@ -1,18 +1,50 @@
 #pragma once
 
 #include <util.h>
+#include <core/component_pool.h>
+#include <core/update_scheduler.h>
+#include <core/scene_commands.h>
+#include <core/spatial_index.h>
 
 struct Camera;
 struct Node;
 struct GPUPointLight;
+struct DrawContext;
 
 struct SceneGraph {
+    // Declared first, so it outlives the proxies of the nodes below.
+    SpatialIndex spatial;
+
     Ref<Node> root;
     Ref<Node> camera;
 
     std::vector<Ref<Node>> leafs;
     std::vector<GPUPointLight> point_lights;
 
+    UpdateScheduler scheduler;
+    SceneCommandBuffer commands;
+
     void update(double delta);
+    // Mesh instances are only drawn if their bounds overlap p_frustum.
+    void draw(DrawContext& p_context, const Frustum& p_frustum);
     void cleanup();
-};
\ No newline at end of file
+
+    // Creates proxies for new meshes, lights and collectibles and refits the
+    // ones whose node moved since the last call.
+    void update_spatial_index();
+
+    // --- Statistics of the last draw ---
+    size_t visible_mesh_count { 0 };
+
+    // Calls p_function on every component of type T whose node is active.
+    template<typename T, typename F>
+    void for_each(F p_function) {
+        ComponentPool<T>::get().for_each(p_function);
+    }
+
+private:
+    std::vector<uint32_t> visible_proxies;
+    // Frustum of the last draw, for the tick rate of components.
+    Frustum view_frustum {};
+    bool has_view { false };
+};
@@ -1,40 +1,154 @@
 #pragma once
+#include <algorithm>
+#include <cstdint>
 #include <functional>
-#include <list>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
-template<typename T, typename... U>
-size_t get_address(std::function<T(U...)> f) {
-    typedef T(fnType)(U...);
-    fnType** fnPointer = f.template target<fnType*>();
-    return (size_t) *fnPointer;
-}
+// Identifies a connection within one signal. IDs are never reused.
+typedef uint32_t SlotID;
+constexpr SlotID INVALID_SLOT = 0;
 
 
-template <typename... Types>
-struct Signal {
-    std::vector<void (*)(Types...)> ptr_observers;
-    std::vector<std::function<void(Types...)>> fn_observers;
+// Bookkeeping for signals with deferred emissions. The queues of all such
+// signals are drained by SignalBase::flush_deferred() once per frame.
+struct SignalBase {
+    virtual ~SignalBase() {
+        if (!queued) return;
+        std::erase(pending_signals, this);
+        std::replace(flushing_signals.begin(), flushing_signals.end(), this, static_cast<SignalBase*>(nullptr));
+    }
 
-    void connect(void (*f)(Types...)) {
-        ptr_observers.push_back(f);
+    static void flush_deferred() {
+        // Signals deferred while flushing are kept for the next flush.
+        flushing_signals.swap(pending_signals);
+        for (size_t index = 0; index < flushing_signals.size(); index++) {
+            SignalBase* signal = flushing_signals[index];
+            if (signal == nullptr) continue;
+            signal->queued = false;
+            signal->flush_queue();
+        }
+        flushing_signals.clear();
     }
 
-    std::vector<std::function<void(Types...)>>::iterator
-    connect(std::function<void(Types...)>& f) {
-        fn_observers.push_back(f);
-        return fn_observers.end();
+protected:
+    bool queued { false };
+
+    void enqueue() {
+        if (queued) return;
+        queued = true;
+        pending_signals.push_back(this);
     }
 
-    void disconnect(std::vector<std::function<void(Types...)>>::iterator handle) {
-        fn_observers.erase(handle);
+    virtual void flush_queue() = 0;
+
+private:
+    inline static std::vector<SignalBase*> pending_signals;
+    inline static std::vector<SignalBase*> flushing_signals;
+};
+
+
+// Observers are stored in place and called by reference, so emitting does
+// not allocate or copy them. Observers may connect and disconnect while the
+// signal is being emitted: new observers are first called by the next emit,
+// disconnected ones are skipped immediately and removed once emitting ends.
+template <typename... Types>
+struct Signal : public SignalBase {
+    SlotID connect(std::function<void(Types...)> p_callback) {
+        const SlotID id = next_id++;
+        if (emit_depth > 0) {
+            pending_slots.push_back(Slot { id, std::move(p_callback) });
+        } else {
+            slots.push_back(Slot { id, std::move(p_callback) });
+        }
+        return id;
     }
-    
-    void emit(Types... arguments) {
-        for (auto f : ptr_observers) {
-            f(arguments...);
+
+    void disconnect(SlotID p_id) {
+        // Slots are sorted by id, since ids only grow.
+        auto slot = std::lower_bound(slots.begin(), slots.end(), p_id,
+            [](const Slot& p_slot, SlotID p_id) { return p_slot.id < p_id; }
+        );
+        if (slot != slots.end() && slot->id == p_id) {
+            if (emit_depth > 0) {
+                // Keeps its id, so the slots stay sorted for other disconnects.
+                if (!slot->disconnected) {
+                    slot->disconnected = true;
+                    disconnected_count += 1;
+                }
+            } else {
+                slots.erase(slot);
+            }
+            return;
         }
-        for (auto f : fn_observers) {
-            f(arguments...);
+        std::erase_if(pending_slots, [p_id](const Slot& p_slot) { return p_slot.id == p_id; });
+    }
+
+    void emit(const Types&... arguments) {
+        emit_depth += 1;
+        // Indexed, so observers connected during the emit can't invalidate
+        // the loop, and bounded, so they aren't called by it.
+        const size_t count = slots.size();
+        for (size_t index = 0; index < count; index++) {
+            if (!slots[index].disconnected) {
+                slots[index].callback(arguments...);
+            }
         }
+        emit_depth -= 1;
+
+        if (emit_depth == 0) {
+            if (disconnected_count > 0) {
+                std::erase_if(slots, [](const Slot& p_slot) { return p_slot.disconnected; });
+                disconnected_count = 0;
+            }
+            if (!pending_slots.empty()) {
+                std::move(pending_slots.begin(), pending_slots.end(), std::back_inserter(slots));
+                pending_slots.clear();
+            }
+        }
+    }
+
+    // Queues the emission until the next SignalBase::flush_deferred().
+    void emit_deferred(const Types&... arguments) {
+        queued_arguments.emplace_back(arguments...);
+        enqueue();
+    }
+
+    size_t connection_count() const {
+        return slots.size() - disconnected_count + pending_slots.size();
+    }
+
+    Signal() {}
+    Signal(const Signal&) = delete;
+    Signal& operator=(const Signal&) = delete;
+
+protected:
+    void flush_queue() override {
+        // Emissions deferred by the observers end up in queued_arguments
+        // again and wait for the next flush.
+        flushing_arguments.swap(queued_arguments);
+        for (auto& arguments : flushing_arguments) {
+            std::apply([this](const auto&... p_arguments) { emit(p_arguments...); }, arguments);
+        }
+        flushing_arguments.clear();
     }
-};
\ No newline at end of file
+
+private:
+    struct Slot {
+        SlotID id;
+        std::function<void(Types...)> callback;
+        // Disconnected while emitting, removed once emitting ends.
+        bool disconnected { false };
+    };
+
+    std::vector<Slot> slots;
+    std::vector<Slot> pending_slots;
+    SlotID next_id { 1 };
+    uint32_t emit_depth { 0 };
+    size_t disconnected_count { 0 };
+
+    // Capacity is kept between frames, so steady state deferral doesn't allocate.
+    std::vector<std::tuple<std::decay_t<Types>...>> queued_arguments;
+    std::vector<std::tuple<std::decay_t<Types>...>> flushing_arguments;
+};
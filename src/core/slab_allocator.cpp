@@ -0,0 +1,97 @@
+#include <core/slab_allocator.h>
+
+#include <algorithm>
+
+SlabPool::SlabPool(size_t p_size) {
+    // Free blocks store the next free block in their payload.
+    const size_t payload = std::max(p_size, sizeof(std::byte*));
+    stride = HEADER_SIZE + (payload + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+}
+
+SlabPool& SlabPool::get(size_t p_size) {
+    const size_t size_class = (p_size + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+    auto pool = pools.find(size_class);
+    if (pool == pools.end()) {
+        // Never freed, so blocks released during static destruction still
+        // have a pool to go back to.
+        pool = pools.emplace(size_class, new SlabPool(size_class)).first;
+    }
+    return *pool->second;
+}
+
+size_t SlabPool::release_all_unused() {
+    size_t released = 0;
+    for (auto& [_size, pool] : pools) {
+        released += pool->release_unused();
+    }
+    return released;
+}
+
+SlabPool::Chunk* SlabPool::allocate_chunk() {
+    Chunk* chunk = new Chunk {
+        .memory = static_cast<std::byte*>(::operator new(stride * BLOCKS_PER_CHUNK)),
+        .free_list = nullptr,
+        .live_count = 0,
+        .available = true,
+    };
+    // Thread the free list front to back.
+    for (size_t index = BLOCKS_PER_CHUNK; index-- > 0;) {
+        std::byte* block = chunk->memory + index * stride;
+        *reinterpret_cast<std::byte**>(block + HEADER_SIZE) = chunk->free_list;
+        chunk->free_list = block;
+    }
+
+    chunks.push_back(chunk);
+    available_chunks.push_back(chunk);
+    chunk_allocations += 1;
+    return chunk;
+}
+
+void* SlabPool::allocate() {
+    Chunk* chunk = available_chunks.empty() ? allocate_chunk() : available_chunks.back();
+
+    std::byte* block = chunk->free_list;
+    chunk->free_list = *reinterpret_cast<std::byte**>(block + HEADER_SIZE);
+    *reinterpret_cast<Chunk**>(block) = chunk;
+    chunk->live_count += 1;
+    live_blocks += 1;
+
+    if (chunk->free_list == nullptr) {
+        chunk->available = false;
+        available_chunks.pop_back();
+    }
+    return block + HEADER_SIZE;
+}
+
+void SlabPool::deallocate(void* p_pointer) {
+    std::byte* block = static_cast<std::byte*>(p_pointer) - HEADER_SIZE;
+    Chunk* chunk = *reinterpret_cast<Chunk**>(block);
+
+    *reinterpret_cast<std::byte**>(block + HEADER_SIZE) = chunk->free_list;
+    chunk->free_list = block;
+    chunk->live_count -= 1;
+    live_blocks -= 1;
+
+    if (!chunk->available) {
+        chunk->available = true;
+        available_chunks.push_back(chunk);
+    }
+}
+
+size_t SlabPool::release_unused() {
+    auto unused = [](Chunk* p_chunk) { return p_chunk->live_count == 0; };
+    std::erase_if(available_chunks, unused);
+
+    size_t released = 0;
+    std::erase_if(chunks, [&](Chunk* p_chunk) {
+        if (p_chunk->live_count != 0) {
+            return false;
+        }
+        ::operator delete(p_chunk->memory);
+        delete p_chunk;
+        released += 1;
+        return true;
+    });
+    chunk_releases += released;
+    return released;
+}
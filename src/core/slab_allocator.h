@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+// Fixed size block allocator. Blocks are carved out of chunks of
+// BLOCKS_PER_CHUNK blocks, so creating many small objects of the same size
+// costs one heap allocation per chunk instead of one per object. Chunks that
+// no longer hold live blocks are only returned to the system in bulk through
+// release_unused(), e.g. once a scene has been torn down.
+struct SlabPool {
+    static constexpr size_t BLOCKS_PER_CHUNK = 256;
+    // Each block starts with a pointer to its chunk, padded so the payload
+    // keeps the default new alignment.
+    static constexpr size_t HEADER_SIZE = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    // --- Counters across all pools ---
+    inline static size_t chunk_allocations { 0 };
+    inline static size_t chunk_releases { 0 };
+    inline static size_t live_blocks { 0 };
+
+    void* allocate();
+    void deallocate(void* p_pointer);
+
+    // Frees all chunks without live blocks, returns the number of chunks freed.
+    size_t release_unused();
+
+    // Shared pool for blocks of at least p_size bytes.
+    static SlabPool& get(size_t p_size);
+    static size_t release_all_unused();
+
+    explicit SlabPool(size_t p_size);
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+private:
+    struct Chunk {
+        std::byte* memory;
+        std::byte* free_list;
+        uint32_t live_count;
+        bool available;
+    };
+
+    size_t stride;
+    std::vector<Chunk*> chunks;
+    // Chunks with at least one free block.
+    std::vector<Chunk*> available_chunks;
+
+    inline static std::unordered_map<size_t, SlabPool*> pools;
+
+    Chunk* allocate_chunk();
+};
+
+
+// Standard allocator on top of the shared slab pools, for use with
+// std::allocate_shared and shared_ptr control blocks.
+template<typename T>
+struct SlabAllocator {
+    using value_type = T;
+
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+    SlabAllocator() = default;
+
+    template<typename U>
+    SlabAllocator(const SlabAllocator<U>&) {}
+
+    T* allocate(size_t p_count) {
+        if (p_count != 1) {
+            return static_cast<T*>(::operator new(p_count * sizeof(T)));
+        }
+        return static_cast<T*>(SlabPool::get(sizeof(T)).allocate());
+    }
+
+    void deallocate(T* p_pointer, size_t p_count) {
+        if (p_count != 1) {
+            ::operator delete(p_pointer);
+            return;
+        }
+        SlabPool::get(sizeof(T)).deallocate(p_pointer);
+    }
+
+    template<typename U>
+    bool operator==(const SlabAllocator<U>&) const {
+        return true;
+    }
+};
@@ -0,0 +1,308 @@
+#include <core/spatial_index.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+// Traversal stacks, kept per thread for their capacity. They grow with the
+// tree, since a degenerate one can be far deeper than a balanced one.
+static thread_local std::vector<uint32_t> query_stack;
+
+struct BatchEntry {
+    uint32_t node;
+    // Queries still overlapping the node.
+    uint64_t queries;
+};
+static thread_local std::vector<BatchEntry> batch_stack;
+
+uint32_t SpatialIndex::allocate_node() {
+    uint32_t node;
+    if (free_list == NULL_PROXY) {
+        node = uint32_t(nodes.size());
+        nodes.emplace_back();
+    } else {
+        node = free_list;
+        free_list = nodes[node].parent;
+    }
+    nodes[node] = TreeNode { .height = 0 };
+    return node;
+}
+
+void SpatialIndex::free_node(uint32_t p_node) {
+    nodes[p_node].parent = free_list;
+    nodes[p_node].height = -1;
+    nodes[p_node].user_data = nullptr;
+    free_list = p_node;
+}
+
+uint32_t SpatialIndex::create_proxy(const AABB& p_box, uint32_t p_category, void* p_user_data) {
+    const uint32_t proxy = allocate_node();
+    nodes[proxy].box = p_box.grow(MARGIN);
+    nodes[proxy].category = p_category;
+    nodes[proxy].user_data = p_user_data;
+    insert_leaf(proxy);
+    proxy_count += 1;
+    return proxy;
+}
+
+void SpatialIndex::destroy_proxy(uint32_t p_proxy) {
+    assert(nodes[p_proxy].is_leaf());
+    remove_leaf(p_proxy);
+    free_node(p_proxy);
+    proxy_count -= 1;
+}
+
+bool SpatialIndex::move_proxy(uint32_t p_proxy, const AABB& p_box) {
+    if (nodes[p_proxy].box.contains(p_box)) {
+        return false;
+    }
+    remove_leaf(p_proxy);
+    nodes[p_proxy].box = p_box.grow(MARGIN);
+    insert_leaf(p_proxy);
+    reinsertions += 1;
+    return true;
+}
+
+void SpatialIndex::insert_leaf(uint32_t p_leaf) {
+    if (root == NULL_PROXY) {
+        root = p_leaf;
+        nodes[root].parent = NULL_PROXY;
+        return;
+    }
+
+    // Descend towards the sibling with the lowest surface area cost.
+    const AABB leaf_box = nodes[p_leaf].box;
+    uint32_t index = root;
+    while (!nodes[index].is_leaf()) {
+        const TreeNode& node = nodes[index];
+        const float area = node.box.get_surface_area();
+        const float combined_area = node.box.merge(leaf_box).get_surface_area();
+
+        // Cost of pairing the leaf with this node, and the cost every
+        // descendant pays for growing this node.
+        const float cost = 2.0f * combined_area;
+        const float inheritance_cost = 2.0f * (combined_area - area);
+
+        auto child_cost = [&](uint32_t p_child) {
+            const AABB& child_box = nodes[p_child].box;
+            const float merged_area = child_box.merge(leaf_box).get_surface_area();
+            if (nodes[p_child].is_leaf()) {
+                return merged_area + inheritance_cost;
+            }
+            return merged_area - child_box.get_surface_area() + inheritance_cost;
+        };
+        const float cost1 = child_cost(node.child1);
+        const float cost2 = child_cost(node.child2);
+
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+        index = (cost1 < cost2) ? node.child1 : node.child2;
+    }
+
+    const uint32_t sibling = index;
+    const uint32_t old_parent = nodes[sibling].parent;
+    const uint32_t new_parent = allocate_node();
+    nodes[new_parent].parent = old_parent;
+    nodes[new_parent].box = leaf_box.merge(nodes[sibling].box);
+    nodes[new_parent].height = nodes[sibling].height + 1;
+    nodes[new_parent].child1 = sibling;
+    nodes[new_parent].child2 = p_leaf;
+    nodes[sibling].parent = new_parent;
+    nodes[p_leaf].parent = new_parent;
+
+    if (old_parent == NULL_PROXY) {
+        root = new_parent;
+    } else if (nodes[old_parent].child1 == sibling) {
+        nodes[old_parent].child1 = new_parent;
+    } else {
+        nodes[old_parent].child2 = new_parent;
+    }
+
+    refit_ancestors(new_parent);
+}
+
+void SpatialIndex::remove_leaf(uint32_t p_leaf) {
+    if (p_leaf == root) {
+        root = NULL_PROXY;
+        return;
+    }
+
+    const uint32_t parent = nodes[p_leaf].parent;
+    const uint32_t grand_parent = nodes[parent].parent;
+    const uint32_t sibling = (nodes[parent].child1 == p_leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+    // The sibling takes the place of the parent.
+    nodes[sibling].parent = grand_parent;
+    free_node(parent);
+    if (grand_parent == NULL_PROXY) {
+        root = sibling;
+        return;
+    }
+    if (nodes[grand_parent].child1 == parent) {
+        nodes[grand_parent].child1 = sibling;
+    } else {
+        nodes[grand_parent].child2 = sibling;
+    }
+    refit_ancestors(grand_parent);
+}
+
+void SpatialIndex::refit_ancestors(uint32_t p_node) {
+    for (uint32_t index = p_node; index != NULL_PROXY; index = nodes[index].parent) {
+        index = balance(index);
+        TreeNode& node = nodes[index];
+        node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+        node.box = nodes[node.child1].box.merge(nodes[node.child2].box);
+    }
+}
+
+uint32_t SpatialIndex::balance(uint32_t p_node) {
+    const uint32_t a = p_node;
+    if (nodes[a].is_leaf() || nodes[a].height < 2) {
+        return a;
+    }
+
+    const uint32_t b = nodes[a].child1;
+    const uint32_t c = nodes[a].child2;
+    const int32_t difference = nodes[c].height - nodes[b].height;
+    if (difference >= -1 && difference <= 1) {
+        return a;
+    }
+
+    // Rotate the taller child up into the place of a. The taller grandchild
+    // stays with it, the shorter one moves over to a.
+    const bool rotate_c = difference > 1;
+    const uint32_t up = rotate_c ? c : b;
+    const uint32_t other = rotate_c ? b : c;
+    const uint32_t grandchild1 = nodes[up].child1;
+    const uint32_t grandchild2 = nodes[up].child2;
+
+    nodes[up].child1 = a;
+    nodes[up].parent = nodes[a].parent;
+    nodes[a].parent = up;
+    const uint32_t up_parent = nodes[up].parent;
+    if (up_parent == NULL_PROXY) {
+        root = up;
+    } else if (nodes[up_parent].child1 == a) {
+        nodes[up_parent].child1 = up;
+    } else {
+        nodes[up_parent].child2 = up;
+    }
+
+    const bool keep_first = nodes[grandchild1].height > nodes[grandchild2].height;
+    const uint32_t kept  = keep_first ? grandchild1 : grandchild2;
+    const uint32_t moved = keep_first ? grandchild2 : grandchild1;
+    nodes[up].child2 = kept;
+    if (rotate_c) {
+        nodes[a].child2 = moved;
+    } else {
+        nodes[a].child1 = moved;
+    }
+    nodes[moved].parent = a;
+
+    nodes[a].box = nodes[other].box.merge(nodes[moved].box);
+    nodes[a].height = 1 + std::max(nodes[other].height, nodes[moved].height);
+    nodes[up].box = nodes[a].box.merge(nodes[kept].box);
+    nodes[up].height = 1 + std::max(nodes[a].height, nodes[kept].height);
+    return up;
+}
+
+template<typename F>
+void SpatialIndex::query(uint32_t p_mask, std::vector<uint32_t>& p_results, F p_test) const {
+    if (root == NULL_PROXY) return;
+
+    std::vector<uint32_t>& stack = query_stack;
+    stack.clear();
+    stack.push_back(root);
+    while (!stack.empty()) {
+        const TreeNode& node = nodes[stack.back()];
+        stack.pop_back();
+        nodes_visited += 1;
+        if (!p_test(node.box)) continue;
+
+        if (node.is_leaf()) {
+            if (node.category & p_mask) {
+                p_results.push_back(uint32_t(&node - nodes.data()));
+            }
+        } else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+void SpatialIndex::query_box(const AABB& p_box, uint32_t p_mask, std::vector<uint32_t>& p_results) const {
+    query(p_mask, p_results, [&](const AABB& p_node_box) { return p_box.overlaps(p_node_box); });
+}
+
+void SpatialIndex::query_sphere(const Sphere& p_sphere, uint32_t p_mask, std::vector<uint32_t>& p_results) const {
+    query(p_mask, p_results, [&](const AABB& p_node_box) { return p_sphere.overlaps(p_node_box); });
+}
+
+void SpatialIndex::query_frustum(const Frustum& p_frustum, uint32_t p_mask, std::vector<uint32_t>& p_results) const {
+    query(p_mask, p_results, [&](const AABB& p_node_box) { return p_frustum.overlaps(p_node_box); });
+}
+
+void SpatialIndex::query_ray(const Ray& p_ray, uint32_t p_mask, std::vector<uint32_t>& p_results) const {
+    query(p_mask, p_results, [&](const AABB& p_node_box) { return p_ray.intersects(p_node_box); });
+}
+
+static bool test(const Sphere& p_sphere, const AABB& p_box)   { return p_sphere.overlaps(p_box); }
+static bool test(const Frustum& p_frustum, const AABB& p_box) { return p_frustum.overlaps(p_box); }
+static bool test(const Ray& p_ray, const AABB& p_box)         { return p_ray.intersects(p_box); }
+
+template<typename Q>
+void SpatialIndex::query_batch(std::span<const Q> p_queries, uint32_t p_mask, std::vector<std::vector<uint32_t>>& p_results) const {
+    p_results.resize(p_queries.size());
+    for (auto& results : p_results) {
+        results.clear();
+    }
+    if (root == NULL_PROXY) return;
+
+    // Each stack entry carries the set of queries still overlapping it, so
+    // the upper levels of the tree are fetched once for the whole batch.
+    std::vector<BatchEntry>& stack = batch_stack;
+    for (size_t batch = 0; batch < p_queries.size(); batch += 64) {
+        const size_t count = std::min<size_t>(64, p_queries.size() - batch);
+        stack.clear();
+        stack.push_back(BatchEntry { root, (count == 64) ? UINT64_MAX : ((uint64_t(1) << count) - 1) });
+
+        while (!stack.empty()) {
+            const BatchEntry entry = stack.back();
+            stack.pop_back();
+            const TreeNode& node = nodes[entry.node];
+            nodes_visited += 1;
+
+            uint64_t passed = 0;
+            for (uint64_t remaining = entry.queries; remaining != 0; remaining &= remaining - 1) {
+                const int bit = std::countr_zero(remaining);
+                if (test(p_queries[batch + bit], node.box)) {
+                    passed |= uint64_t(1) << bit;
+                }
+            }
+            if (passed == 0) continue;
+
+            if (node.is_leaf()) {
+                if (!(node.category & p_mask)) continue;
+                for (; passed != 0; passed &= passed - 1) {
+                    p_results[batch + std::countr_zero(passed)].push_back(entry.node);
+                }
+            } else {
+                stack.push_back(BatchEntry { node.child1, passed });
+                stack.push_back(BatchEntry { node.child2, passed });
+            }
+        }
+    }
+}
+
+void SpatialIndex::query_spheres(std::span<const Sphere> p_spheres, uint32_t p_mask, std::vector<std::vector<uint32_t>>& p_results) const {
+    query_batch(p_spheres, p_mask, p_results);
+}
+
+void SpatialIndex::query_frustums(std::span<const Frustum> p_frustums, uint32_t p_mask, std::vector<std::vector<uint32_t>>& p_results) const {
+    query_batch(p_frustums, p_mask, p_results);
+}
+
+void SpatialIndex::query_rays(std::span<const Ray> p_rays, uint32_t p_mask, std::vector<std::vector<uint32_t>>& p_results) const {
+    query_batch(p_rays, p_mask, p_results);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <math.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Categories a proxy can belong to, queries only report proxies whose
+// category matches their mask.
+namespace SpatialCategory {
+    constexpr uint32_t MESH    = 1 << 0;
+    constexpr uint32_t LIGHT   = 1 << 1;
+    constexpr uint32_t TRIGGER = 1 << 2;
+    constexpr uint32_t ALL     = UINT32_MAX;
+}
+
+// Dynamic AABB tree over everything in the scene that has bounds. Leaves
+// store a fattened box, so small movements don't touch the tree at all, and
+// the tree is kept balanced with rotations on insertion and removal.
+//
+// Proxy ids are the indices of their leaves and stay valid until the proxy
+// is destroyed.
+struct SpatialIndex {
+    static constexpr uint32_t NULL_PROXY = UINT32_MAX;
+    static constexpr float MARGIN = 0.1f;
+
+    uint32_t create_proxy(const AABB& p_box, uint32_t p_category, void* p_user_data);
+    void destroy_proxy(uint32_t p_proxy);
+
+    // Returns true if the proxy left its fat box and had to be reinserted.
+    bool move_proxy(uint32_t p_proxy, const AABB& p_box);
+
+    void* get_user_data(uint32_t p_proxy) const {
+        return nodes[p_proxy].user_data;
+    }
+
+    const AABB& get_fat_box(uint32_t p_proxy) const {
+        return nodes[p_proxy].box;
+    }
+
+    // Append the proxies whose fat box passes the test to p_results.
+    void query_box(const AABB& p_box, uint32_t p_mask, std::vector<uint32_t>& p_results) const;
+    void query_sphere(const Sphere& p_sphere, uint32_t p_mask, std::vector<uint32_t>& p_results) const;
+    void query_frustum(const Frustum& p_frustum, uint32_t p_mask, std::vector<uint32_t>& p_results) const;
+    void query_ray(const Ray& p_ray, uint32_t p_mask, std::vector<uint32_t>& p_results) const;
+
+    // Batched queries walk the tree once for up to 64 queries at a time.
+    // p_results is resized to the number of queries and cleared, results of
+    // query i end up in p_results[i].
+    void query_spheres(std::span<const Sphere> p_spheres, uint32_t p_mask, std::vector<std::vector<uint32_t>>& p_results) const;
+    void query_frustums(std::span<const Frustum> p_frustums, uint32_t p_mask, std::vector<std::vector<uint32_t>>& p_results) const;
+    void query_rays(std::span<const Ray> p_rays, uint32_t p_mask, std::vector<std::vector<uint32_t>>& p_results) const;
+
+    size_t size() const {
+        return proxy_count;
+    }
+
+    int32_t get_height() const {
+        return root == NULL_PROXY ? 0 : nodes[root].height;
+    }
+
+    // --- Statistics, reset by the owner ---
+    mutable size_t nodes_visited { 0 };
+    size_t reinsertions { 0 };
+
+private:
+    struct TreeNode {
+        AABB box;
+        // Doubles as the next free node while on the free list.
+        uint32_t parent { NULL_PROXY };
+        uint32_t child1 { NULL_PROXY };
+        uint32_t child2 { NULL_PROXY };
+        // Leaves have height 0, free nodes -1.
+        int32_t height { -1 };
+        uint32_t category { 0 };
+        void* user_data { nullptr };
+
+        bool is_leaf() const {
+            return child1 == NULL_PROXY;
+        }
+    };
+
+    std::vector<TreeNode> nodes;
+    uint32_t root { NULL_PROXY };
+    uint32_t free_list { NULL_PROXY };
+    size_t proxy_count { 0 };
+
+    uint32_t allocate_node();
+    void free_node(uint32_t p_node);
+
+    void insert_leaf(uint32_t p_leaf);
+    void remove_leaf(uint32_t p_leaf);
+    // Walks from p_node to the root, rebalancing and refitting on the way.
+    void refit_ancestors(uint32_t p_node);
+    uint32_t balance(uint32_t p_node);
+
+    template<typename F>
+    void query(uint32_t p_mask, std::vector<uint32_t>& p_results, F p_test) const;
+
+    template<typename Q>
+    void query_batch(std::span<const Q> p_queries, uint32_t p_mask, std::vector<std::vector<uint32_t>>& p_results) const;
+};
+
+
+// Membership of a component in a spatial index. The proxy is created and
+// kept up to date by SceneGraph::update_spatial_index() and removed again
+// when the owning component is destroyed.
+struct SpatialProxy {
+    SpatialIndex* index { nullptr };
+    uint32_t id { SpatialIndex::NULL_PROXY };
+    // Transform stamp of the node the bounds were last computed from.
+    uint32_t transform_stamp { 0 };
+
+    SpatialProxy() {}
+    SpatialProxy(const SpatialProxy&) = delete;
+    SpatialProxy& operator=(const SpatialProxy&) = delete;
+
+    ~SpatialProxy() {
+        if (index != nullptr) {
+            index->destroy_proxy(id);
+        }
+    }
+};
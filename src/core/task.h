@@ -0,0 +1,201 @@
+#pragma once
+
+#include <core/task_scheduler.h>
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace prosper {
+
+template<typename T = void>
+struct Task;
+
+namespace detail {
+    struct PromiseBase {
+        std::coroutine_handle<> continuation;
+        bool detached { false };
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+
+            template<typename P>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<P> p_handle) noexcept {
+                PromiseBase& promise = p_handle.promise();
+                if (promise.continuation) {
+                    return promise.continuation;
+                }
+                if (promise.detached) {
+                    p_handle.destroy();
+                }
+                return std::noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    template<typename T>
+    struct Promise : PromiseBase {
+        std::optional<T> value;
+
+        void return_value(T p_value) {
+            value = std::move(p_value);
+        }
+
+        T take_result() {
+            return std::move(*value);
+        }
+    };
+
+    template<>
+    struct Promise<void> : PromiseBase {
+        void return_void() {}
+        void take_result() {}
+    };
+}
+
+// Lazily started coroutine. Awaiting a task runs it and resumes the awaiting
+// coroutine once it finishes, on whichever thread the task finished on.
+// Tasks that nobody awaits are run with start().
+template<typename T>
+struct Task {
+    struct promise_type : detail::Promise<T> {
+        Task get_return_object() {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+    };
+
+    Task(Task&& p_other) noexcept : handle(std::exchange(p_other.handle, {})) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> p_continuation) noexcept {
+        handle.promise().continuation = p_continuation;
+        return handle;
+    }
+
+    T await_resume() {
+        return handle.promise().take_result();
+    }
+
+    // Runs the task up to its first suspension without waiting for it. The
+    // coroutine frees itself when done.
+    void start() && {
+        auto started = std::exchange(handle, {});
+        started.promise().detached = true;
+        started.resume();
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit Task(std::coroutine_handle<promise_type> p_handle) : handle(p_handle) {}
+};
+
+
+// --- Awaiters ---
+
+// Continues the coroutine on a loader thread.
+struct ResumeOnWorker {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> p_handle) const {
+        TaskScheduler::run_on_worker([p_handle] { p_handle.resume(); });
+    }
+    void await_resume() const noexcept {}
+};
+
+// Continues the coroutine on the main thread, during the next poll().
+struct ResumeOnMain {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> p_handle) const {
+        TaskScheduler::run_on_main([p_handle] { p_handle.resume(); });
+    }
+    void await_resume() const noexcept {}
+};
+
+// Continues the coroutine on the main thread once p_ready returns true,
+// which poll() checks every frame. Meant for GPU fences and the like.
+struct WaitUntil {
+    std::function<bool()> ready;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> p_handle) {
+        TaskScheduler::run_on_main_when(std::move(ready), [p_handle] { p_handle.resume(); });
+    }
+    void await_resume() const noexcept {}
+};
+
+inline ResumeOnWorker resume_on_worker() { return {}; }
+inline ResumeOnMain resume_on_main() { return {}; }
+inline WaitUntil wait_until(std::function<bool()> p_ready) { return WaitUntil { std::move(p_ready) }; }
+
+// Runs all tasks at once and continues once every one of them finished, on
+// the thread that finished last.
+struct WhenAll {
+    std::vector<Task<void>> tasks;
+    std::atomic<size_t> remaining { 0 };
+    std::coroutine_handle<> waiter;
+
+    bool await_ready() const noexcept { return tasks.empty(); }
+
+    bool await_suspend(std::coroutine_handle<> p_handle) {
+        waiter = p_handle;
+        // One extra count for this function, so tasks finishing right away
+        // can't resume the waiter before all of them are started.
+        remaining = tasks.size() + 1;
+        for (auto& task : tasks) {
+            run(std::move(task), this).start();
+        }
+        return remaining.fetch_sub(1) != 1;
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    static Task<void> run(Task<void> p_task, WhenAll* p_all) {
+        co_await p_task;
+        if (p_all->remaining.fetch_sub(1) == 1) {
+            p_all->waiter.resume();
+        }
+    }
+};
+
+inline WhenAll when_all(std::vector<Task<void>> p_tasks) {
+    return WhenAll { std::move(p_tasks) };
+}
+
+// Reads a whole file on a loader thread. Empty if it can't be read.
+inline Task<std::vector<char>> read_file(std::string p_path) {
+    co_await resume_on_worker();
+    std::vector<char> bytes;
+    std::ifstream file(p_path, std::ios::binary | std::ios::ate);
+    if (file.is_open()) {
+        bytes.resize(size_t(file.tellg()));
+        file.seekg(0);
+        file.read(bytes.data(), std::streamsize(bytes.size()));
+    }
+    co_return bytes;
+}
+
+}
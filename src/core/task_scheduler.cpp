@@ -0,0 +1,130 @@
+#include <core/task_scheduler.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::mutex job_mutex;
+    std::condition_variable job_available;
+    // Signalled when the queue is empty and no worker runs a job.
+    std::condition_variable workers_idle;
+    std::deque<std::function<void()>> jobs;
+    std::vector<std::jthread> workers;
+    uint32_t busy_workers { 0 };
+    bool stopping { false };
+
+    struct MainJob {
+        std::function<bool()> ready;
+        std::function<void()> job;
+    };
+    std::mutex main_mutex;
+    std::vector<MainJob> main_jobs;
+
+    void run_worker() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock lock(job_mutex);
+                job_available.wait(lock, [] { return stopping || !jobs.empty(); });
+                if (stopping) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                busy_workers++;
+            }
+            job();
+            {
+                std::lock_guard lock(job_mutex);
+                busy_workers--;
+                if (jobs.empty() && busy_workers == 0) {
+                    workers_idle.notify_all();
+                }
+            }
+        }
+    }
+
+    bool has_main_jobs() {
+        std::lock_guard lock(main_mutex);
+        return !main_jobs.empty();
+    }
+}
+
+namespace prosper {
+
+void TaskScheduler::run_on_worker(std::function<void()> p_job) {
+    std::lock_guard lock(job_mutex);
+    if (stopping) return;
+    if (workers.empty()) {
+        // Loads mostly wait on the disk and the upload queue, a few threads
+        // are enough to overlap them.
+        const uint32_t worker_count = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+        for (uint32_t index = 0; index < worker_count; index++) {
+            workers.emplace_back(run_worker);
+        }
+    }
+    jobs.push_back(std::move(p_job));
+    job_available.notify_one();
+}
+
+void TaskScheduler::run_on_main(std::function<void()> p_job) {
+    std::lock_guard lock(main_mutex);
+    main_jobs.push_back(MainJob { nullptr, std::move(p_job) });
+}
+
+void TaskScheduler::run_on_main_when(std::function<bool()> p_ready, std::function<void()> p_job) {
+    std::lock_guard lock(main_mutex);
+    main_jobs.push_back(MainJob { std::move(p_ready), std::move(p_job) });
+}
+
+void TaskScheduler::poll() {
+    std::vector<MainJob> current;
+    {
+        std::lock_guard lock(main_mutex);
+        current.swap(main_jobs);
+    }
+
+    // Jobs run here may queue new ones, those wait for the next poll.
+    std::vector<MainJob> waiting;
+    for (auto& main_job : current) {
+        if (main_job.ready && !main_job.ready()) {
+            waiting.push_back(std::move(main_job));
+            continue;
+        }
+        main_job.job();
+    }
+
+    if (!waiting.empty()) {
+        std::lock_guard lock(main_mutex);
+        main_jobs.insert(main_jobs.begin(), std::make_move_iterator(waiting.begin()), std::make_move_iterator(waiting.end()));
+    }
+}
+
+void TaskScheduler::shutdown() {
+    // Queued jobs resume coroutines. Dropping them would leak the coroutine
+    // frames and what they hold, like the fences of uploads in flight, so
+    // they are run to the end. Main thread jobs can queue worker jobs and the
+    // other way around, so both are drained until neither has any left.
+    while (true) {
+        {
+            std::unique_lock lock(job_mutex);
+            workers_idle.wait(lock, [] { return jobs.empty() && busy_workers == 0; });
+        }
+        if (!has_main_jobs()) {
+            break;
+        }
+        poll();
+        std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard lock(job_mutex);
+        stopping = true;
+    }
+    job_available.notify_all();
+    workers.clear();
+}
+
+}
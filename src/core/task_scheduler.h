@@ -0,0 +1,29 @@
+#pragma once
+
+#include <functional>
+
+namespace prosper {
+
+// Where coroutines continue after a suspension: a small pool of loader
+// threads, or the main thread during poll().
+struct TaskScheduler {
+    // Runs p_job on one of the loader threads, which are started on first use.
+    static void run_on_worker(std::function<void()> p_job);
+
+    // Runs p_job on the main thread during the next poll().
+    static void run_on_main(std::function<void()> p_job);
+
+    // Runs p_job on the main thread during the first poll() that finds
+    // p_ready returning true.
+    static void run_on_main_when(std::function<bool()> p_ready, std::function<void()> p_job);
+
+    // Runs the main thread jobs that are due. Called once per frame.
+    static void poll();
+
+    // Runs the queued jobs and the main thread jobs they lead to until none
+    // are left, then stops the loader threads. Blocks the calling thread,
+    // which has to be the main thread.
+    static void shutdown();
+};
+
+}
@@ -0,0 +1,218 @@
+#include <core/transform_store.h>
+
+#include <algorithm>
+
+uint32_t TransformStore::allocate() {
+    uint32_t id;
+    if (free_ids.empty()) {
+        id = uint32_t(id_to_index.size());
+        id_to_index.push_back(INVALID_INDEX);
+        id_parents.push_back(INVALID_INDEX);
+        id_alive.push_back(0);
+    } else {
+        id = free_ids.back();
+        free_ids.pop_back();
+    }
+
+    // New entries start out as roots, so appending them keeps the order valid.
+    const uint32_t index = uint32_t(positions.size());
+    positions.push_back(Vec3(0.0f));
+    rotations.push_back(glm::identity<Quaternion>());
+    scales.push_back(1.0f);
+    parents.push_back(INVALID_INDEX);
+    subtree_ends.push_back(index + 1);
+    dirty.push_back(1);
+    change_stamps.push_back(++change_counter);
+    global_transforms.emplace_back();
+    world_matrices.emplace_back(1.0f);
+    index_to_id.push_back(id);
+
+    id_to_index[id] = index;
+    id_parents[id] = INVALID_INDEX;
+    id_alive[id] = 1;
+    return id;
+}
+
+void TransformStore::release(uint32_t p_id) {
+    id_alive[p_id] = 0;
+    id_parents[p_id] = INVALID_INDEX;
+    free_ids.push_back(p_id);
+    order_dirty = true;
+}
+
+void TransformStore::set_parent(uint32_t p_id, uint32_t p_parent_id) {
+    id_parents[p_id] = p_parent_id;
+    order_dirty = true;
+}
+
+void TransformStore::set_dirty(uint32_t p_id) {
+    if (deferred_dirty != nullptr) {
+        deferred_dirty->push_back(p_id);
+        return;
+    }
+
+    if (mark_dirty(p_id, change_counter + 1)) {
+        change_counter++;
+    }
+}
+
+void TransformStore::set_dirty(std::span<const uint32_t> p_ids) {
+    const uint32_t stamp = change_counter + 1;
+    bool marked = false;
+    for (uint32_t id : p_ids) {
+        marked |= mark_dirty(id, stamp);
+    }
+    if (marked) {
+        change_counter = stamp;
+    }
+}
+
+bool TransformStore::mark_dirty(uint32_t p_id, uint32_t p_stamp) {
+    // Re-sorting marks every entry as dirty anyway.
+    if (order_dirty) return false;
+
+    const uint32_t index = id_to_index[p_id];
+    // If this entry is already dirty, so is its whole subtree.
+    if (dirty[index]) return false;
+    std::fill(dirty.begin() + index, dirty.begin() + subtree_ends[index], 1);
+    std::fill(change_stamps.begin() + index, change_stamps.begin() + subtree_ends[index], p_stamp);
+    return true;
+}
+
+Transform TransformStore::get_local_transform(uint32_t p_index) const {
+    return Transform(positions[p_index], rotations[p_index], scales[p_index]);
+}
+
+Transform TransformStore::get_global_transform(uint32_t p_id) {
+    if (order_dirty) {
+        // Dense parent indices are out of date until the next update(), so walk
+        // the stable ids instead of re-sorting in the middle of building a scene.
+        Transform global = get_local_transform(id_to_index[p_id]);
+        for (uint32_t parent = id_parents[p_id]; parent != INVALID_INDEX; parent = id_parents[parent]) {
+            global = get_local_transform(id_to_index[parent]) * global;
+        }
+        return global;
+    }
+
+    const uint32_t index = id_to_index[p_id];
+    resolve(index);
+    return global_transforms[index];
+}
+
+const Mat4& TransformStore::get_world_matrix(uint32_t p_id) {
+    if (order_dirty) {
+        rebuild_order();
+    }
+
+    const uint32_t index = id_to_index[p_id];
+    resolve(index);
+    return world_matrices[index];
+}
+
+void TransformStore::resolve(uint32_t p_index) {
+    if (!dirty[p_index]) return;
+
+    const uint32_t parent = parents[p_index];
+    if (parent == INVALID_INDEX) {
+        global_transforms[p_index] = get_local_transform(p_index);
+    } else {
+        resolve(parent);
+        global_transforms[p_index] = global_transforms[parent] * get_local_transform(p_index);
+    }
+    world_matrices[p_index] = global_transforms[p_index].get_matrix();
+    dirty[p_index] = 0;
+}
+
+void TransformStore::update() {
+    if (order_dirty) {
+        rebuild_order();
+    }
+
+    // Parents come before their children and a dirty entry always has a dirty
+    // subtree, so a single pass in storage order is enough.
+    const uint32_t count = uint32_t(size());
+    for (uint32_t index = 0; index < count; index++) {
+        if (!dirty[index]) continue;
+
+        const uint32_t parent = parents[index];
+        if (parent == INVALID_INDEX) {
+            global_transforms[index] = get_local_transform(index);
+        } else {
+            global_transforms[index] = global_transforms[parent] * get_local_transform(index);
+        }
+        world_matrices[index] = global_transforms[index].get_matrix();
+        dirty[index] = 0;
+    }
+}
+
+void TransformStore::rebuild_order() {
+    const uint32_t id_count = uint32_t(id_to_index.size());
+
+    // Child lists by id, roots go straight onto the traversal stack.
+    std::vector<uint32_t> first_child(id_count, INVALID_INDEX);
+    std::vector<uint32_t> next_sibling(id_count, INVALID_INDEX);
+    std::vector<uint32_t> stack;
+    for (uint32_t id = 0; id < id_count; id++) {
+        if (!id_alive[id]) continue;
+
+        const uint32_t parent = id_parents[id];
+        if (parent == INVALID_INDEX || !id_alive[parent]) {
+            stack.push_back(id);
+        } else {
+            next_sibling[id] = first_child[parent];
+            first_child[parent] = id;
+        }
+    }
+
+    // Depth first traversal, which keeps every subtree contiguous.
+    std::vector<uint32_t> order;
+    order.reserve(id_count - free_ids.size());
+    while (!stack.empty()) {
+        const uint32_t id = stack.back();
+        stack.pop_back();
+        order.push_back(id);
+        for (uint32_t child = first_child[id]; child != INVALID_INDEX; child = next_sibling[child]) {
+            stack.push_back(child);
+        }
+    }
+
+    const uint32_t count = uint32_t(order.size());
+    std::vector<Vec3> new_positions(count);
+    std::vector<Quaternion> new_rotations(count);
+    std::vector<float> new_scales(count);
+    for (uint32_t index = 0; index < count; index++) {
+        const uint32_t old_index = id_to_index[order[index]];
+        new_positions[index] = positions[old_index];
+        new_rotations[index] = rotations[old_index];
+        new_scales[index]    = scales[old_index];
+    }
+    positions = std::move(new_positions);
+    rotations = std::move(new_rotations);
+    scales    = std::move(new_scales);
+
+    std::fill(id_to_index.begin(), id_to_index.end(), INVALID_INDEX);
+    for (uint32_t index = 0; index < count; index++) {
+        id_to_index[order[index]] = index;
+    }
+
+    parents.resize(count);
+    subtree_ends.resize(count);
+    for (uint32_t index = 0; index < count; index++) {
+        const uint32_t parent = id_parents[order[index]];
+        parents[index] = (parent == INVALID_INDEX) ? INVALID_INDEX : id_to_index[parent];
+        subtree_ends[index] = index + 1;
+    }
+    for (uint32_t index = count; index-- > 0;) {
+        const uint32_t parent = parents[index];
+        if (parent != INVALID_INDEX) {
+            subtree_ends[parent] = std::max(subtree_ends[parent], subtree_ends[index]);
+        }
+    }
+
+    global_transforms.resize(count);
+    world_matrices.resize(count);
+    dirty.assign(count, 1);
+    change_stamps.assign(count, ++change_counter);
+    index_to_id = std::move(order);
+    order_dirty = false;
+}
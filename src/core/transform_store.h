@@ -0,0 +1,85 @@
+#pragma once
+
+#include <math.h>
+#include <span>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Flat storage for the transforms of all nodes. Entries live in parallel
+// arrays sorted depth first, so every parent comes before its children and
+// the subtree of an entry is the contiguous range [index, subtree_end).
+// Global transforms are resolved lazily on read, or all at once by update()
+// in a single linear pass.
+//
+// Nodes refer to their entry through a stable id, since the dense index of
+// an entry changes whenever the hierarchy is re-sorted.
+struct TransformStore {
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    // --- Indexed by dense index ---
+    std::vector<Vec3> positions;
+    std::vector<Quaternion> rotations;
+    std::vector<float> scales;
+    std::vector<uint32_t> parents;
+    std::vector<uint32_t> subtree_ends;
+    std::vector<uint8_t> dirty;
+    std::vector<uint32_t> change_stamps;
+    std::vector<Transform> global_transforms;
+    std::vector<Mat4> world_matrices;
+
+    uint32_t allocate();
+    void release(uint32_t p_id);
+    void set_parent(uint32_t p_id, uint32_t p_parent_id);
+
+    uint32_t index(uint32_t p_id) const {
+        return id_to_index[p_id];
+    }
+
+    // Marks the entry and its whole subtree as needing a new global transform.
+    // On job threads only records the id, see deferred_dirty.
+    void set_dirty(uint32_t p_id);
+
+    // Set by update jobs to their own list. The dirty flags of a subtree may
+    // overlap other jobs' entries, so the main thread marks the recorded ids
+    // once the jobs are done.
+    inline static thread_local std::vector<uint32_t>* deferred_dirty { nullptr };
+    // Marks the ids recorded by jobs, all with the same change stamp.
+    void set_dirty(std::span<const uint32_t> p_ids);
+
+    Transform get_global_transform(uint32_t p_id);
+    const Mat4& get_world_matrix(uint32_t p_id);
+
+    // Changes whenever the global transform of the entry may have changed.
+    // Compare against a previously read stamp to find out if it did.
+    uint32_t get_change_stamp(uint32_t p_id) const {
+        return order_dirty ? change_counter + 1 : change_stamps[id_to_index[p_id]];
+    }
+
+    // Re-sorts the hierarchy if it changed and resolves all dirty global
+    // transforms. Called once per frame before the scene is drawn.
+    void update();
+
+    size_t size() const {
+        return positions.size();
+    }
+
+private:
+    // --- Indexed by stable id ---
+    std::vector<uint32_t> id_to_index;
+    std::vector<uint32_t> id_parents;
+    std::vector<uint8_t> id_alive;
+    std::vector<uint32_t> free_ids;
+
+    // --- Indexed by dense index ---
+    std::vector<uint32_t> index_to_id;
+
+    bool order_dirty { false };
+    // Main thread only, jobs defer their set_dirty calls.
+    uint32_t change_counter { 0 };
+
+    void rebuild_order();
+    bool mark_dirty(uint32_t p_id, uint32_t p_stamp);
+    void resolve(uint32_t p_index);
+    Transform get_local_transform(uint32_t p_index) const;
+};
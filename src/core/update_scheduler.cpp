@@ -0,0 +1,121 @@
+#include <core/update_scheduler.h>
+#include <core/component_pool.h>
+#include <core/transform_store.h>
+#include <rendering/types.h>
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/JobSystem.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+extern PerformanceStats gStats;
+extern TransformStore gTransforms;
+
+static_assert(sizeof(PerformanceStats::update_phase_times) / sizeof(float) == UPDATE_PHASE_COUNT);
+
+void UpdateScheduler::add_callback(UpdatePhase p_phase, std::function<void(double)> p_callback) {
+    callbacks[uint32_t(p_phase)].push_back(p_callback);
+}
+
+void UpdateScheduler::run(double p_delta) {
+    for (uint32_t phase = 0; phase < UPDATE_PHASE_COUNT; phase++) {
+        auto start_time = std::chrono::steady_clock::now();
+
+        if (UpdatePhase(phase) == UpdatePhase::PreRender) {
+            // Resolve all transforms up front, so pre-render components can
+            // read world matrices from several threads without writing to the
+            // transform store.
+            gTransforms.update();
+        }
+        run_phase(UpdatePhase(phase), p_delta);
+
+        auto end_time = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+        gStats.update_phase_times[phase] = elapsed.count() / 1000.0f;
+    }
+}
+
+void UpdateScheduler::run_phase(UpdatePhase p_phase, double p_delta) {
+    for (auto& callback : callbacks[uint32_t(p_phase)]) {
+        callback(p_delta);
+    }
+
+    auto& pools = ComponentPoolBase::update_pools[uint32_t(p_phase)];
+    size_t group_start = 0;
+    while (group_start < pools.size()) {
+        // Pools with the same update order don't depend on each other.
+        size_t group_end = group_start + 1;
+        while (group_end < pools.size() && pools[group_end]->update_order == pools[group_start]->update_order) {
+            group_end++;
+        }
+
+        // Transforms each job marked dirty, sized up front so the jobs can
+        // hold on to their list.
+        size_t job_count = 0;
+        for (size_t index = group_start; index < group_end; index++) {
+            ComponentPoolBase* pool = pools[index];
+            const size_t size = pool->size();
+            if (pool->thread_safe && job_system != nullptr && size > BATCH_SIZE) {
+                job_count += (size + BATCH_SIZE - 1) / BATCH_SIZE;
+            }
+        }
+        job_dirty_ids.resize(std::max(job_dirty_ids.size(), job_count));
+
+        JPH::JobSystem::Barrier* barrier = nullptr;
+        size_t job_index = 0;
+        for (size_t index = group_start; index < group_end; index++) {
+            ComponentPoolBase* pool = pools[index];
+            const size_t size = pool->size();
+            if (!pool->thread_safe || job_system == nullptr || size <= BATCH_SIZE) {
+                continue;
+            }
+            if (barrier == nullptr) {
+                barrier = job_system->CreateBarrier();
+            }
+            for (size_t begin = 0; begin < size; begin += BATCH_SIZE) {
+                const size_t end = std::min(begin + BATCH_SIZE, size);
+                std::vector<uint32_t>* dirty_ids = &job_dirty_ids[job_index++];
+                auto handle = job_system->CreateJob("Component update", JPH::Color::sGreen, [pool, p_delta, begin, end, dirty_ids]() {
+                    TransformStore::deferred_dirty = dirty_ids;
+                    pool->update(p_delta, begin, end);
+                    TransformStore::deferred_dirty = nullptr;
+                });
+                barrier->AddJob(handle);
+            }
+        }
+
+        // Everything that didn't go to the workers runs here in the meantime.
+        for (size_t index = group_start; index < group_end; index++) {
+            ComponentPoolBase* pool = pools[index];
+            const size_t size = pool->size();
+            if (!pool->thread_safe || job_system == nullptr || size <= BATCH_SIZE) {
+                // No upper bound, so components added during the update are
+                // picked up as before.
+                pool->update(p_delta, 0, SIZE_MAX);
+            }
+        }
+
+        if (barrier != nullptr) {
+            job_system->WaitForJobs(barrier);
+            job_system->DestroyBarrier(barrier);
+        }
+        for (size_t job = 0; job < job_count; job++) {
+            gTransforms.set_dirty(job_dirty_ids[job]);
+            job_dirty_ids[job].clear();
+        }
+        group_start = group_end;
+    }
+}
+
+const char* UpdateScheduler::get_phase_name(UpdatePhase p_phase) {
+    switch (p_phase) {
+        case UpdatePhase::Input:       return "Input";
+        case UpdatePhase::PrePhysics:  return "Pre-physics";
+        case UpdatePhase::Physics:     return "Physics";
+        case UpdatePhase::PostPhysics: return "Post-physics";
+        case UpdatePhase::PreRender:   return "Pre-render";
+    }
+    return "Unknown";
+}
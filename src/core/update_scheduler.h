@@ -0,0 +1,34 @@
+#pragma once
+
+#include <core/component.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace JPH {
+    class JobSystem;
+}
+
+// Runs the update phases of the scene in order. Each phase first calls the
+// callbacks registered for it, then updates the component pools declared for
+// it. Thread safe pools are split into batches and handed to the job system,
+// while the main thread runs the remaining pools of the same update order.
+struct UpdateScheduler {
+    // Components per job when splitting up thread safe pools.
+    static constexpr size_t BATCH_SIZE = 256;
+
+    JPH::JobSystem* job_system { nullptr };
+
+    void add_callback(UpdatePhase p_phase, std::function<void(double)> p_callback);
+    void run(double p_delta);
+
+    static const char* get_phase_name(UpdatePhase p_phase);
+
+private:
+    std::vector<std::function<void(double)>> callbacks[UPDATE_PHASE_COUNT];
+    // Kept between phases for their capacity.
+    std::vector<std::vector<uint32_t>> job_dirty_ids;
+
+    void run_phase(UpdatePhase p_phase, double p_delta);
+};
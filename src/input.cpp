@@ -1,6 +1,13 @@
 #include <input.h>
+#include <core/node.h>
+
+#include <algorithm>
 
 const bool* Input::keyboard_state;
+bool Input::coalesce_mouse_motion { true };
+std::unordered_map<uint32_t, std::vector<Component*>> Input::subscribers;
+SDL_Event Input::pending_motion;
+bool Input::has_pending_motion { false };
 
 
 void Input::initialize() {
@@ -16,8 +23,62 @@ void Input::initialize() {
     }
 }
 
+void Input::subscribe(SDL_EventType p_type, Component* p_component) {
+    auto& list = subscribers[p_type];
+    if (std::find(list.begin(), list.end(), p_component) == list.end()) {
+        list.push_back(p_component);
+    }
+}
+
+void Input::unsubscribe(SDL_EventType p_type, Component* p_component) {
+    auto list = subscribers.find(p_type);
+    if (list != subscribers.end()) {
+        std::erase(list->second, p_component);
+    }
+}
+
+void Input::unsubscribe(Component* p_component) {
+    for (auto& [_type, list] : subscribers) {
+        std::erase(list, p_component);
+    }
+}
+
 void Input::process_event(SDL_Event& event) {
-    // TODO: Does this need to do anything?
+    if (event.type == SDL_EVENT_MOUSE_MOTION && coalesce_mouse_motion) {
+        if (has_pending_motion) {
+            const float xrel = pending_motion.motion.xrel + event.motion.xrel;
+            const float yrel = pending_motion.motion.yrel + event.motion.yrel;
+            pending_motion = event;
+            pending_motion.motion.xrel = xrel;
+            pending_motion.motion.yrel = yrel;
+        } else {
+            pending_motion = event;
+            has_pending_motion = true;
+        }
+        return;
+    }
+    dispatch(event);
+}
+
+void Input::flush() {
+    if (has_pending_motion) {
+        has_pending_motion = false;
+        dispatch(pending_motion);
+    }
+}
+
+void Input::dispatch(SDL_Event& event) {
+    auto list = subscribers.find(event.type);
+    if (list == subscribers.end()) {
+        return;
+    }
+    // Indexed, since handlers may subscribe other components.
+    for (size_t index = 0; index < list->second.size(); index++) {
+        Component* component = list->second[index];
+        if (component->node->is_active_in_tree()) {
+            component->process_input(event);
+        }
+    }
 }
 
 bool Input::is_pressed(SDL_Scancode scancode) {
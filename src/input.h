@@ -3,15 +3,36 @@
 #include <util.h>
 #include <math.h>
 #include <unordered_map>
+#include <vector>
 #include <SDL3/SDL.h>
 
+struct Component;
+
 class Input {
 public:
     static const bool* keyboard_state;
 
+    // Sum up mouse motion and deliver it as a single event per frame.
+    static bool coalesce_mouse_motion;
+
     static bool is_pressed(SDL_Scancode keycode);
     static Vec2 get_movement_input();
 
+    // Events of the given type are passed to the component's process_input()
+    // while its node is active. Components unsubscribe before they go away.
+    static void subscribe(SDL_EventType p_type, Component* p_component);
+    static void unsubscribe(SDL_EventType p_type, Component* p_component);
+    static void unsubscribe(Component* p_component);
+
     static void process_event(SDL_Event& event);
+    // Delivers coalesced events, called once per frame after polling.
+    static void flush();
     static void initialize();
+
+private:
+    static std::unordered_map<uint32_t, std::vector<Component*>> subscribers;
+    static SDL_Event pending_motion;
+    static bool has_pending_motion;
+
+    static void dispatch(SDL_Event& event);
 };
\ No newline at end of file
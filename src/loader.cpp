@@ -9,22 +9,35 @@
 #include <components/point_light.h>
 #include <components/skinned_mesh.h>
 #include <components/physics/static_body.h>
+#include <core/mapped_file.h>
 #include <core/node.h>
 #include <core/resource_manager.h>
+#include <resources/imported_model.h>
 #include <resources/mesh.h>
 #include <resources/texture.h>
 
 #include <stb_image.h>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
 #include <span>
+#include <sstream>
+#include <thread>
 
 #include <variant>
 #include <fastgltf/core.hpp>
 #include <fastgltf/tools.hpp>
 #include <fastgltf/glm_element_traits.hpp>
+#include <glm/gtc/packing.hpp>
 
 #include <ktxvulkan.h>
+#include <meshoptimizer.h>
 #include <yaml.h>
 
 #include <Jolt/Jolt.h>
@@ -64,6 +77,62 @@ SamplerAddressMode extract_address_mode(fastgltf::Wrap wrap) {
     return SamplerAddressMode::eRepeat;
 }
 
+// Path of the content with the given hash in the shared cache.
+static std::string get_cache_path(ResourceID p_id, std::string_view p_extension) {
+    return std::format("{}/{}{}", CONTENT_CACHE_DIRECTORY, p_id.to_string(), p_extension);
+}
+
+// Files are written under a temporary name and renamed once complete, so
+// import jobs writing the same file at once never see a partial one.
+static std::string get_temporary_path(const std::string& p_path) {
+    static std::atomic<uint32_t> temporary_index { 0 };
+    return std::format("{}.{}.tmp", p_path, temporary_index++);
+}
+
+static void replace_with_temporary(const std::string& p_temporary_path, const std::string& p_path) {
+    std::error_code error;
+    std::filesystem::rename(p_temporary_path, p_path, error);
+    if (error) {
+        std::filesystem::remove(p_temporary_path, error);
+    }
+}
+
+// Name of the cache file to try when the one at p_id holds other content.
+static ResourceID next_cache_id(ResourceID p_id) {
+    return ResourceID::from_bytes(&p_id.value, sizeof(p_id.value), p_id);
+}
+
+static bool cached_file_matches(const std::string& p_path, const void* p_data, size_t p_size) {
+    std::error_code error;
+    if (std::filesystem::file_size(p_path, error) != p_size || error) {
+        return false;
+    }
+    MappedFile file;
+    return p_size == 0 || (file.open(p_path) && std::memcmp(file.data(), p_data, p_size) == 0);
+}
+
+// Stores p_data in the shared cache under its content hash, unless the same
+// content is there already. The hash is only 64 bits, so a file of other
+// content with the same name moves this one to the next free name.
+static ResourceID store_in_cache(const void* p_data, size_t p_size, std::string_view p_extension, std::string& r_path) {
+    ResourceID id = ResourceID::from_bytes(p_data, p_size);
+    r_path = get_cache_path(id, p_extension);
+    while (std::filesystem::exists(r_path) && !cached_file_matches(r_path, p_data, p_size)) {
+        print("Cache collision at %s", r_path.c_str());
+        id = next_cache_id(id);
+        r_path = get_cache_path(id, p_extension);
+    }
+    if (!std::filesystem::exists(r_path)) {
+        const std::string temporary_path = get_temporary_path(r_path);
+        {
+            std::ofstream output(temporary_path, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+            output.write(static_cast<const char*>(p_data), std::streamsize(p_size));
+        }
+        replace_with_temporary(temporary_path, r_path);
+    }
+    return id;
+}
+
 SamplerMipmapMode extract_mipmap_mode(fastgltf::Filter filter)
 {
     switch (filter) {
@@ -81,38 +150,15 @@ SamplerMipmapMode extract_mipmap_mode(fastgltf::Filter filter)
 std::optional<AllocatedImage> load_image(Renderer* p_renderer, std::filesystem::path p_file_path, Format p_format) {
     AllocatedImage new_image {};
     if (p_file_path.extension() == ".ktx2") {
-        ktxTexture2* k_texture;
-        auto result = ktxTexture2_CreateFromNamedFile(p_file_path.c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &k_texture);
-        if (result != KTX_SUCCESS) {
-            print("Could not create KTX texture!");
+        std::ifstream file(p_file_path, std::ifstream::in | std::ifstream::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        ktxTexture2* k_texture = create_ktx_texture(bytes.data(), bytes.size());
+        if (k_texture == nullptr) {
+            return {};
         }
 
-        auto color_model = ktxTexture2_GetColorModel_e(k_texture);
-        ktx_transcode_fmt_e texture_format;
-        PhysicalDeviceFeatures features = p_renderer->physical_device.getFeatures();
-        if (color_model != KHR_DF_MODEL_RGBSDA) {
-            if (color_model == KHR_DF_MODEL_UASTC && features.textureCompressionASTC_LDR) {
-                texture_format = KTX_TTF_ASTC_4x4_RGBA;
-            } else if (color_model == KHR_DF_MODEL_ETC1S && features.textureCompressionETC2) {
-                texture_format = KTX_TTF_ETC;
-            } else if (features.textureCompressionASTC_LDR) {
-                texture_format = KTX_TTF_ASTC_4x4_RGBA;
-            } else if (features.textureCompressionETC2) {
-                texture_format = KTX_TTF_ETC2_RGBA;
-            } else if (features.textureCompressionBC) {
-                texture_format = KTX_TTF_BC3_RGBA;
-            } else {
-                print("Could not transcode texture!");
-                return {};
-            }
-            result = ktxTexture2_TranscodeBasis(k_texture, KTX_TTF_BC7_RGBA, 0);
-            if (result != KTX_SUCCESS) {
-                print("Could not transcode texture!");
-            }
-        }
-        
         ktxVulkanTexture texture;
-        result = ktxTexture2_VkUploadEx(k_texture, &p_renderer->ktx_device_info, &texture, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        auto result = ktxTexture2_VkUploadEx(k_texture, &p_renderer->ktx_device_info, &texture, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
         if (result != KTX_SUCCESS) {
             print("Could not upload KTX texture!");
         }
@@ -211,10 +257,696 @@ std::optional<AllocatedImage> load_image(Renderer* p_renderer, fastgltf::Asset&
     }
 }
 
-void import_gltf_scene(Renderer* p_renderer, std::filesystem::path p_file_path) {
+// --- Import jobs ---
+
+// Runs p_job for every index below p_count on all cores and returns once all
+// of them are done. Jobs only write results of their own, which are merged
+// in order afterwards, so the output doesn't depend on the number of threads.
+static void parallel_for(size_t p_count, const std::function<void(size_t)>& p_job) {
+    std::atomic<size_t> next_index { 0 };
+    auto work = [&]() {
+        for (size_t index = next_index++; index < p_count; index = next_index++) {
+            p_job(index);
+        }
+    };
+    const size_t thread_count = std::min<size_t>(p_count, std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::jthread> threads;
+    for (size_t thread_index = 1; thread_index < thread_count; thread_index++) {
+        threads.emplace_back(work);
+    }
+    work();
+}
+
+// How an image is converted, from the import settings. Images without
+// settings get an entry with the defaults.
+struct TextureImportSettings {
+    VkFormat format { VK_FORMAT_R8G8B8A8_UNORM };
+    // Used as a normal map by a material, its mips are renormalized.
+    bool normal_map { false };
+    // "none", or Basis Universal "etc1s" or "uastc".
+    std::string compression { "none" };
+};
+
+static TextureImportSettings get_texture_settings(YAML::Node& p_import_settings, const char* p_image_name, bool p_normal_map) {
+    TextureImportSettings settings { .normal_map = p_normal_map };
+    for (auto texture : p_import_settings["Textures"]) {
+        if (texture["name"].as<std::string>() == p_image_name) {
+            settings.format = texture["sRGB"].as<bool>() ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+            if (texture["compression"]) {
+                settings.compression = texture["compression"].as<std::string>();
+            }
+            return settings;
+        }
+    }
+    YAML::Node texture_node {};
+    texture_node["name"] = p_image_name;
+    texture_node["sRGB"] = false;
+    texture_node["compression"] = settings.compression;
+    p_import_settings["Textures"].push_back(texture_node);
+    return settings;
+}
+
+// Bumped when converted textures change, so older ones in the cache are
+// not used.
+constexpr uint32_t TEXTURE_CONVERSION_VERSION = 2;
+
+// Cache key of a converted image.
+static ResourceID get_converted_id(const void* p_source, size_t p_size, const TextureImportSettings& p_settings, ResourceID p_seed = ResourceID::from_name("")) {
+    const uint32_t key[] = {
+        TEXTURE_CONVERSION_VERSION,
+        uint32_t(p_settings.format),
+        uint32_t(p_settings.normal_map),
+    };
+    ResourceID id = ResourceID::from_bytes(p_source, p_size, p_seed);
+    id = ResourceID::from_bytes(key, sizeof(key), id);
+    return ResourceID::from_bytes(p_settings.compression.data(), p_settings.compression.size(), id);
+}
+
+static float srgb_to_linear(float p_value) {
+    return p_value <= 0.04045f ? p_value / 12.92f : std::pow((p_value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float linear_to_srgb(float p_value) {
+    return p_value <= 0.0031308f ? p_value * 12.92f : 1.055f * std::pow(p_value, 1.0f / 2.4f) - 0.055f;
+}
+
+// Next mip level, each texel the average of 2x2 texels of the level above.
+// Texels are filtered as floats, in linear space for sRGB images and as
+// vectors for normal maps.
+template<typename Fetch>
+static std::vector<Vec4> downsample(uint32_t p_width, uint32_t p_height, Fetch p_fetch) {
+    const uint32_t width = std::max(1u, p_width / 2);
+    const uint32_t height = std::max(1u, p_height / 2);
+    std::vector<Vec4> level(size_t(width) * height);
+    for (uint32_t y = 0; y < height; y++) {
+        const uint32_t y0 = std::min(2 * y, p_height - 1);
+        const uint32_t y1 = std::min(2 * y + 1, p_height - 1);
+        for (uint32_t x = 0; x < width; x++) {
+            const uint32_t x0 = std::min(2 * x, p_width - 1);
+            const uint32_t x1 = std::min(2 * x + 1, p_width - 1);
+            level[size_t(y) * width + x] = 0.25f * (p_fetch(x0, y0) + p_fetch(x1, y0) + p_fetch(x0, y1) + p_fetch(x1, y1));
+        }
+    }
+    return level;
+}
+
+// Mip levels below the first of RGBA8 pixels, down to 1x1.
+static std::vector<std::vector<uint8_t>> generate_mip_chain(const uint8_t* p_pixels, uint32_t p_width, uint32_t p_height, const TextureImportSettings& p_settings) {
+    const bool srgb = p_settings.format == VK_FORMAT_R8G8B8A8_SRGB && !p_settings.normal_map;
+    float decode_table[256];
+    for (int value = 0; value < 256; value++) {
+        const float normalized = value / 255.0f;
+        decode_table[value] = p_settings.normal_map ? normalized * 2.0f - 1.0f : (srgb ? srgb_to_linear(normalized) : normalized);
+    }
+    auto decode = [&](const uint8_t* p_texel) {
+        return Vec4(decode_table[p_texel[0]], decode_table[p_texel[1]], decode_table[p_texel[2]], p_texel[3] / 255.0f);
+    };
+    auto encode = [&](Vec4 p_texel, uint8_t* r_texel) {
+        Vec3 color = Vec3(p_texel);
+        if (p_settings.normal_map) {
+            const float length = glm::length(color);
+            color = (length > 1e-6f ? color / length : Vec3(0.0f, 0.0f, 1.0f)) * 0.5f + 0.5f;
+        } else if (srgb) {
+            color = Vec3(linear_to_srgb(color.r), linear_to_srgb(color.g), linear_to_srgb(color.b));
+        }
+        const Vec4 encoded = glm::clamp(Vec4(color, p_texel.a), 0.0f, 1.0f) * 255.0f + 0.5f;
+        r_texel[0] = uint8_t(encoded.r);
+        r_texel[1] = uint8_t(encoded.g);
+        r_texel[2] = uint8_t(encoded.b);
+        r_texel[3] = uint8_t(encoded.a);
+    };
+
+    std::vector<std::vector<uint8_t>> levels;
+    uint32_t width = p_width;
+    uint32_t height = p_height;
+    std::vector<Vec4> level = downsample(width, height, [&](uint32_t x, uint32_t y) {
+        return decode(p_pixels + (size_t(y) * p_width + x) * 4);
+    });
+    while (width > 1 || height > 1) {
+        width = std::max(1u, width / 2);
+        height = std::max(1u, height / 2);
+        std::vector<uint8_t>& bytes = levels.emplace_back(level.size() * 4);
+        for (size_t texel = 0; texel < level.size(); texel++) {
+            encode(level[texel], &bytes[texel * 4]);
+        }
+        if (width > 1 || height > 1) {
+            level = downsample(width, height, [&, level_width = width](uint32_t x, uint32_t y) {
+                return level[size_t(y) * level_width + x];
+            });
+        }
+    }
+    return levels;
+}
+
+// Writes RGBA8 pixels with a full mip chain as a KTX2 file, Basis Universal
+// compressed if the settings ask for it.
+static void write_ktx(unsigned char* p_pixels, int p_width, int p_height, const TextureImportSettings& p_settings, ResourceID p_check, const std::string& p_path) {
+    const auto mip_levels = generate_mip_chain(p_pixels, p_width, p_height, p_settings);
+    ktxTexture2* texture;
+    ktxTextureCreateInfo ktx_info {
+        .vkFormat = p_settings.format,
+        .baseWidth = (ktx_uint32_t)p_width,
+        .baseHeight = (ktx_uint32_t)p_height,
+        .baseDepth = 1,
+        .numDimensions = 2,
+        .numLevels = (ktx_uint32_t)mip_levels.size() + 1,
+        .numLayers = (ktx_uint32_t)1,
+        .numFaces = (ktx_uint32_t)1,
+        .isArray = KTX_FALSE,
+        .generateMipmaps = KTX_FALSE,
+    };
+    if (ktxTexture2_Create(&ktx_info, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &texture) != KTX_SUCCESS) {
+        print("Could not create KTX texture!");
+        return;
+    }
+    ktxTexture_SetImageFromMemory(ktxTexture(texture), 0, 0, 0, p_pixels, size_t(p_width) * p_height * 4);
+    for (uint32_t level = 0; level < mip_levels.size(); level++) {
+        ktxTexture_SetImageFromMemory(ktxTexture(texture), level + 1, 0, 0, mip_levels[level].data(), mip_levels[level].size());
+    }
+
+    if (p_settings.compression == "etc1s" || p_settings.compression == "uastc") {
+        const bool uastc = p_settings.compression == "uastc";
+        ktxBasisParams params {};
+        params.structSize = sizeof(params);
+        params.uastc = uastc;
+        // Images are already imported in parallel.
+        params.threadCount = 1;
+        params.compressionLevel = KTX_ETC1S_DEFAULT_COMPRESSION_LEVEL;
+        params.qualityLevel = 128;
+        params.uastcFlags = KTX_PACK_UASTC_LEVEL_DEFAULT;
+        params.normalMap = p_settings.normal_map && !uastc;
+        KTX_error_code result = ktxTexture2_CompressBasisEx(texture, &params);
+        // ETC1S is supercompressed with BasisLZ already, UASTC gets zstd.
+        if (result == KTX_SUCCESS && uastc) {
+            result = ktxTexture2_DeflateZstd(texture, 18);
+        }
+        if (result != KTX_SUCCESS) {
+            print("Could not compress %s: %s", p_path.c_str(), ktxErrorString(result));
+        }
+    } else if (p_settings.compression != "none") {
+        print("Unknown texture compression '%s'!", p_settings.compression.c_str());
+    }
+
+    set_ktx_source(texture, p_check);
+    const std::string temporary_path = get_temporary_path(p_path);
+    ktxTexture_WriteToNamedFile(ktxTexture(texture), temporary_path.c_str());
+    replace_with_temporary(temporary_path, p_path);
+    ktxTexture_Destroy(ktxTexture(texture));
+}
+
+struct ImportedImageResult {
+    // Invalid if the image couldn't be imported.
+    ResourceID id;
+    std::string cache_path;
+};
+
+// Converts encoded image bytes into a KTX2 file in the cache, unless it is
+// there already.
+static ImportedImageResult convert_image(const void* p_source, size_t p_size, const TextureImportSettings& p_settings) {
+    ResourceID id = get_converted_id(p_source, p_size, p_settings);
+    const ResourceID check = get_converted_id(p_source, p_size, p_settings, CACHE_CHECK_SEED);
+    std::string path = get_cache_path(id, ".ktx2");
+    ktxTexture2* cached;
+    while (ktxTexture2_CreateFromNamedFile(path.c_str(), KTX_TEXTURE_CREATE_NO_FLAGS, &cached) == KTX_SUCCESS) {
+        const CacheCheck match = check_ktx_source(cached, check);
+        ktxTexture2_Destroy(cached);
+        if (match == CacheCheck::MATCH) {
+            return ImportedImageResult { id, path };
+        }
+        if (match == CacheCheck::MISSING) {
+            break;
+        }
+        print("Cache collision at %s", path.c_str());
+        id = next_cache_id(id);
+        path = get_cache_path(id, ".ktx2");
+    }
+    int width, height, number_channels;
+    unsigned char* data = stbi_load_from_memory((const stbi_uc*) p_source, static_cast<int>(p_size), &width, &height, &number_channels, 4);
+    if (data == nullptr) {
+        return {};
+    }
+    write_ktx(data, width, height, p_settings, check, path);
+    stbi_image_free(data);
+    return ImportedImageResult { id, path };
+}
+
+static ImportedImageResult import_image(const fastgltf::Asset& p_asset, const fastgltf::Image& p_image, const std::filesystem::path& p_file_path, const TextureImportSettings& p_settings) {
+    ImportedImageResult result {};
+    std::visit(
+        fastgltf::visitor {
+            [](const auto& argument) {},
+            [&](const fastgltf::sources::URI& file_path) {
+                assert(file_path.fileByteOffset == 0);
+                assert(file_path.uri.isLocalPath());
+                const auto full_path = p_file_path.parent_path().string() + "/" + file_path.uri.c_str();
+                const auto ktx_path = std::format("{}.{}", full_path, "ktx2");
+                // A KTX2 file next to the image is used as is, stored by
+                // content so one shared by several models is loaded once.
+                const bool prepared = std::filesystem::exists(ktx_path);
+                std::ifstream source(prepared ? ktx_path : full_path, std::ifstream::in | std::ifstream::binary);
+                std::vector<char> bytes((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+                if (prepared) {
+                    result.id = store_in_cache(bytes.data(), bytes.size(), ".ktx2", result.cache_path);
+                } else {
+                    result = convert_image(bytes.data(), bytes.size(), p_settings);
+                }
+                if (result.id.is_valid()) {
+                    ResourceID::register_name(result.id, prepared ? ktx_path : full_path);
+                }
+            },
+            [&](const fastgltf::sources::BufferView& view) {
+                auto& buffer_view = p_asset.bufferViews[view.bufferViewIndex];
+                auto& buffer = p_asset.buffers[buffer_view.bufferIndex];
+                std::visit(
+                    fastgltf::visitor {
+                        [](const auto& argument) {},
+                        [&](const fastgltf::sources::Array& array) {
+                            const auto* source = reinterpret_cast<const char*>(array.bytes.data()) + buffer_view.byteOffset;
+                            result = convert_image(source, buffer_view.byteLength, p_settings);
+                            if (result.id.is_valid()) {
+                                ResourceID::register_name(result.id, std::format("{}/{}", p_file_path.c_str(), p_image.name.c_str()));
+                            }
+                        }
+                    }, buffer.data
+                );
+            },
+        }, p_image.data
+    );
+    return result;
+}
+
+struct ImportedAnimationResult {
+    float length { 0.0f };
+    // Ordered by node, for the same output on every import.
+    std::map<uint32_t, AnimationChannel> channels;
+};
+
+static ImportedAnimationResult import_animation(const fastgltf::Asset& p_asset, const fastgltf::Animation& p_animation) {
+    ImportedAnimationResult result {};
+    for (const auto& gltf_channel : p_animation.channels) {
+        const auto& animation_sampler = p_animation.samplers[gltf_channel.samplerIndex];
+        const auto& input_accessor = p_asset.accessors[animation_sampler.inputAccessor];
+        const auto& output_accessor = p_asset.accessors[animation_sampler.outputAccessor];
+        auto channel = &result.channels[gltf_channel.nodeIndex.value()];
+        if (gltf_channel.path == fastgltf::AnimationPath::Translation) {
+            fastgltf::iterateAccessorWithIndex<float>(p_asset, input_accessor,
+                [&](float p_time, size_t index) {
+                    result.length = std::max(result.length, p_time);
+                    KeyframePosition keyframe;
+                    keyframe.time = p_time;
+                    channel->position_keyframes.push_back(keyframe);
+                }
+            );
+            fastgltf::iterateAccessorWithIndex<Vec3>(p_asset, output_accessor,
+                [&](Vec3 p_position, size_t index) {
+                    channel->position_keyframes[index].position = p_position;
+                }
+            );
+        } else if (gltf_channel.path == fastgltf::AnimationPath::Rotation) {
+            fastgltf::iterateAccessorWithIndex<float>(p_asset, input_accessor,
+                [&](float p_time, size_t index) {
+                    result.length = std::max(result.length, p_time);
+                    KeyframeRotation keyframe;
+                    keyframe.time = p_time;
+                    channel->rotation_keyframes.push_back(keyframe);
+                }
+            );
+            fastgltf::iterateAccessorWithIndex<Vec4>(p_asset, output_accessor,
+                [&](Vec4 p_rotation, size_t index) {
+                    channel->rotation_keyframes[index].rotation = Quaternion(p_rotation[3], p_rotation[0], p_rotation[1], p_rotation[2]);
+                }
+            );
+        }
+    }
+    return result;
+}
+
+// Vertex data of a mesh. Primitives are imported into their own ranges of
+// it, which are laid out up front.
+struct ImportedMeshGeometry {
+    ImportedMeshData data;
+    std::vector<ImportedSurface> surfaces;
+    // First vertex of each surface, and the vertex count last.
+    std::vector<size_t> first_vertices;
+};
+
+struct PrimitiveJob {
+    size_t mesh_index;
+    size_t primitive_index;
+    size_t first_index;
+    size_t first_vertex;
+};
+
+static void import_primitive(const fastgltf::Asset& p_asset, const fastgltf::Primitive& p_primitive, size_t p_first_index, size_t p_first_vertex, ImportedMeshData& r_data) {
+    // Indices
+    {
+        const fastgltf::Accessor& index_accessor = p_asset.accessors[p_primitive.indicesAccessor.value()];
+        fastgltf::iterateAccessorWithIndex<std::uint32_t>(p_asset, index_accessor,
+            [&](std::uint32_t index, size_t position) {
+                r_data.indices[p_first_index + position] = p_first_vertex + index;
+            }
+        );
+    }
+
+    // Positions
+    {
+        const fastgltf::Accessor& position_accessor = p_asset.accessors[p_primitive.findAttribute("POSITION")->accessorIndex];
+        fastgltf::iterateAccessorWithIndex<glm::vec3>(p_asset, position_accessor,
+            [&](glm::vec3 vector, size_t index) {
+                Vertex new_vertex {
+                    .position = vector,
+                    .uv_x = 0.0f,
+                    .normal = { 1.0f, 0.0f, 0.0f },
+                    .uv_y = 0.0f,
+                    .color = Vec4(1.0f),
+                };
+                r_data.vertices[p_first_vertex + index] = new_vertex;
+            }
+        );
+    }
+
+    // Normals
+    auto normals = p_primitive.findAttribute("NORMAL");
+    if (normals != p_primitive.attributes.end()) {
+        fastgltf::iterateAccessorWithIndex<Vec3>(p_asset, p_asset.accessors[(*normals).accessorIndex],
+            [&](Vec3 normal, size_t index) {
+                r_data.vertices[p_first_vertex + index].normal = glm::normalize(normal);
+            }
+        );
+    }
+
+    // Tangents
+    auto tangents = p_primitive.findAttribute("TANGENT");
+    if (tangents != p_primitive.attributes.end()) {
+        fastgltf::iterateAccessorWithIndex<Vec4>(p_asset, p_asset.accessors[(*tangents).accessorIndex],
+            [&](Vec4 tangent, size_t index) {
+                r_data.vertices[p_first_vertex + index].tangent = tangent;
+            }
+        );
+    }
+
+    // UV
+    auto tex_coord = p_primitive.findAttribute("TEXCOORD_0");
+    if (tex_coord != p_primitive.attributes.end()) {
+        fastgltf::iterateAccessorWithIndex<Vec2>(p_asset, p_asset.accessors[(*tex_coord).accessorIndex],
+            [&](Vec2 uv, size_t index) {
+                r_data.vertices[p_first_vertex + index].uv_x = uv.x;
+                r_data.vertices[p_first_vertex + index].uv_y = uv.y;
+            }
+        );
+    }
+
+    // Color
+    auto color_attribute = p_primitive.findAttribute("COLOR_1");
+    if (color_attribute != p_primitive.attributes.end()) {
+        fastgltf::iterateAccessorWithIndex<Vec4>(p_asset, p_asset.accessors[(*color_attribute).accessorIndex],
+            [&](Vec4 color, size_t index) {
+                r_data.vertices[p_first_vertex + index].color = color;
+            }
+        );
+    }
+    
+    // Joints
+    auto joint_attribute = p_primitive.findAttribute(std::format("JOINTS_{}", 0));
+    if (joint_attribute != p_primitive.attributes.end()) {
+        const fastgltf::Accessor& joint_accessor = p_asset.accessors[joint_attribute->accessorIndex];
+        fastgltf::iterateAccessorWithIndex<Vec4>(p_asset, joint_accessor,
+            [&](Vec4 joint, size_t index) {
+                r_data.skinning_data[p_first_vertex + index] = SkinningData {
+                    .joint_ids = {
+                        uint32_t(p_asset.skins[0].joints[uint32_t(joint.x)]),
+                        uint32_t(p_asset.skins[0].joints[uint32_t(joint.y)]),
+                        uint32_t(p_asset.skins[0].joints[uint32_t(joint.z)]),
+                        uint32_t(p_asset.skins[0].joints[uint32_t(joint.w)]),
+                    }
+                };
+            }
+        );
+
+        auto weights_attribute = p_primitive.findAttribute(std::format("WEIGHTS_{}", 0));
+        assert(weights_attribute != p_primitive.attributes.end());
+        const fastgltf::Accessor& weight_accessor = p_asset.accessors[weights_attribute->accessorIndex];
+        fastgltf::iterateAccessorWithIndex<Vec4>(p_asset, weight_accessor,
+            [&](Vec4 weights, size_t index) {
+                r_data.skinning_data[p_first_vertex + index].weights = weights;
+            }
+        );
+    }
+}
+
+// Cache size the statistics are measured with, about what GPUs reuse.
+constexpr unsigned int VERTEX_CACHE_SIZE = 16;
+
+struct OptimizedSurface {
+    std::vector<Vertex> vertices;
+    std::vector<SkinningData> skinning_data;
+    // Relative to the first vertex of the surface.
+    std::vector<uint32_t> indices;
+    meshopt_VertexCacheStatistics before {};
+    meshopt_VertexCacheStatistics after {};
+};
+
+// Welds exact duplicate vertices of a surface, orders its triangles for the
+// post-transform cache and then for less overdraw, and its vertices in the
+// order they are fetched.
+static OptimizedSurface optimize_surface(const ImportedMeshData& p_data, const ImportedSurface& p_surface, size_t p_first_vertex, size_t p_vertex_count) {
+    OptimizedSurface result;
+    const size_t index_count = p_surface.count;
+    const bool skinned = !p_data.skinning_data.empty();
+    const Vertex* vertices = p_data.vertices.data() + p_first_vertex;
+    const SkinningData* skinning_data = skinned ? p_data.skinning_data.data() + p_first_vertex : nullptr;
+    result.indices.resize(index_count);
+    for (size_t index = 0; index < index_count; index++) {
+        result.indices[index] = p_data.indices[p_surface.start_index + index] - uint32_t(p_first_vertex);
+    }
+
+    // Only triangle lists are optimized, others are kept as they are.
+    if (index_count == 0 || index_count % 3 != 0) {
+        result.vertices.assign(vertices, vertices + p_vertex_count);
+        if (skinned) {
+            result.skinning_data.assign(skinning_data, skinning_data + p_vertex_count);
+        }
+        return result;
+    }
+    result.before = meshopt_analyzeVertexCache(result.indices.data(), index_count, p_vertex_count, VERTEX_CACHE_SIZE, 0, 0);
+
+    std::vector<meshopt_Stream> streams { { vertices, sizeof(Vertex), sizeof(Vertex) } };
+    if (skinned) {
+        streams.push_back({ skinning_data, sizeof(SkinningData), sizeof(SkinningData) });
+    }
+    std::vector<uint32_t> remap(p_vertex_count);
+    size_t vertex_count = meshopt_generateVertexRemapMulti(remap.data(), result.indices.data(), index_count, p_vertex_count, streams.data(), streams.size());
+    meshopt_remapIndexBuffer(result.indices.data(), result.indices.data(), index_count, remap.data());
+    result.vertices.resize(vertex_count);
+    meshopt_remapVertexBuffer(result.vertices.data(), vertices, p_vertex_count, sizeof(Vertex), remap.data());
+    if (skinned) {
+        result.skinning_data.resize(vertex_count);
+        meshopt_remapVertexBuffer(result.skinning_data.data(), skinning_data, p_vertex_count, sizeof(SkinningData), remap.data());
+    }
+
+    meshopt_optimizeVertexCache(result.indices.data(), result.indices.data(), index_count, vertex_count);
+    meshopt_optimizeOverdraw(result.indices.data(), result.indices.data(), index_count, &result.vertices[0].position.x, vertex_count, sizeof(Vertex), 1.05f);
+
+    const size_t fetched_count = meshopt_optimizeVertexFetchRemap(remap.data(), result.indices.data(), index_count, vertex_count);
+    meshopt_remapIndexBuffer(result.indices.data(), result.indices.data(), index_count, remap.data());
+    meshopt_remapVertexBuffer(result.vertices.data(), result.vertices.data(), vertex_count, sizeof(Vertex), remap.data());
+    result.vertices.resize(fetched_count);
+    if (skinned) {
+        meshopt_remapVertexBuffer(result.skinning_data.data(), result.skinning_data.data(), vertex_count, sizeof(SkinningData), remap.data());
+        result.skinning_data.resize(fetched_count);
+    }
+
+    result.after = meshopt_analyzeVertexCache(result.indices.data(), index_count, fetched_count, VERTEX_CACHE_SIZE, 0, 0);
+    return result;
+}
+
+// Optimizes every surface on its own and packs them back together, printing
+// the average cache miss ratio (vertices transformed per triangle) and
+// transform to vertex ratio before and after.
+static void optimize_mesh(ImportedMeshGeometry& r_geometry, std::string_view p_name) {
+    std::vector<OptimizedSurface> optimized(r_geometry.surfaces.size());
+    parallel_for(optimized.size(), [&](size_t p_index) {
+        const size_t first_vertex = r_geometry.first_vertices[p_index];
+        const size_t vertex_count = r_geometry.first_vertices[p_index + 1] - first_vertex;
+        optimized[p_index] = optimize_surface(r_geometry.data, r_geometry.surfaces[p_index], first_vertex, vertex_count);
+    });
+
+    const size_t vertex_count_before = r_geometry.data.vertices.size();
+    const bool skinned = !r_geometry.data.skinning_data.empty();
+    ImportedMeshData& data = r_geometry.data;
+    data.vertices.clear();
+    data.skinning_data.clear();
+    data.indices.clear();
+    size_t triangles = 0;
+    size_t transformed_before = 0;
+    size_t transformed_after = 0;
+    for (size_t surface_index = 0; surface_index < optimized.size(); surface_index++) {
+        const OptimizedSurface& surface = optimized[surface_index];
+        const uint32_t first_vertex = uint32_t(data.vertices.size());
+        r_geometry.first_vertices[surface_index] = first_vertex;
+        r_geometry.surfaces[surface_index].start_index = uint32_t(data.indices.size());
+        for (uint32_t index : surface.indices) {
+            data.indices.push_back(first_vertex + index);
+        }
+        data.vertices.insert(data.vertices.end(), surface.vertices.begin(), surface.vertices.end());
+        if (skinned) {
+            data.skinning_data.insert(data.skinning_data.end(), surface.skinning_data.begin(), surface.skinning_data.end());
+        }
+        if (surface.before.vertices_transformed > 0) {
+            triangles += surface.indices.size() / 3;
+            transformed_before += surface.before.vertices_transformed;
+            transformed_after += surface.after.vertices_transformed;
+        }
+    }
+    r_geometry.first_vertices.back() = data.vertices.size();
+
+    if (triangles > 0) {
+        print("Optimized mesh '%.*s': %zu -> %zu vertices, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+            int(p_name.size()), p_name.data(), vertex_count_before, data.vertices.size(),
+            double(transformed_before) / triangles, double(transformed_after) / triangles,
+            double(transformed_before) / vertex_count_before, double(transformed_after) / std::max<size_t>(1, data.vertices.size()));
+    }
+}
+
+// Index data for the GPU, each surface's indices counting from its first
+// vertex and 16 bit where it has few enough vertices. Surfaces start on a
+// multiple of their index size, so one buffer serves both index types.
+static void pack_indices(ImportedMeshGeometry& r_geometry) {
+    std::vector<uint8_t>& index_data = r_geometry.data.index_data;
+    index_data.clear();
+    for (size_t surface_index = 0; surface_index < r_geometry.surfaces.size(); surface_index++) {
+        ImportedSurface& surface = r_geometry.surfaces[surface_index];
+        const size_t first_vertex = r_geometry.first_vertices[surface_index];
+        const size_t vertex_count = r_geometry.first_vertices[surface_index + 1] - first_vertex;
+        const uint32_t index_size = vertex_count <= std::numeric_limits<uint16_t>::max() ? sizeof(uint16_t) : sizeof(uint32_t);
+        const std::span<const uint32_t> indices(r_geometry.data.indices.data() + surface.start_index, surface.count);
+
+        index_data.resize((index_data.size() + index_size - 1) / index_size * index_size);
+        surface.start_index = uint32_t(index_data.size() / index_size);
+        surface.vertex_offset = int32_t(first_vertex);
+        surface.index_size = index_size;
+        for (uint32_t index : indices) {
+            const uint32_t relative_index = index - uint32_t(first_vertex);
+            const uint16_t short_index = uint16_t(relative_index);
+            const uint8_t* bytes = index_size == sizeof(uint16_t)
+                ? reinterpret_cast<const uint8_t*>(&short_index)
+                : reinterpret_cast<const uint8_t*>(&relative_index);
+            index_data.insert(index_data.end(), bytes, bytes + index_size);
+        }
+    }
+}
+
+// Mesh options from the import settings, like get_texture_settings.
+static bool get_compress_vertices(YAML::Node& p_import_settings, const char* p_mesh_name, std::optional<bool> p_override) {
+    for (auto mesh : p_import_settings["Meshes"]) {
+        if (mesh["name"].as<std::string>() == p_mesh_name) {
+            if (p_override.has_value()) {
+                mesh["compress_vertices"] = *p_override;
+            }
+            return mesh["compress_vertices"].as<bool>();
+        }
+    }
+    YAML::Node mesh_node {};
+    mesh_node["name"] = p_mesh_name;
+    mesh_node["compress_vertices"] = p_override.value_or(false);
+    p_import_settings["Meshes"].push_back(mesh_node);
+    return p_override.value_or(false);
+}
+
+std::optional<bool> get_imported_compress_vertices(const std::filesystem::path& p_file_path) {
+    const std::string import_settings_path = std::format("{}.import", p_file_path.c_str());
+    if (!std::filesystem::exists(import_settings_path)) {
+        return {};
+    }
+    // Only the first mesh is imported.
+    const YAML::Node meshes = YAML::LoadFile(import_settings_path)["Meshes"];
+    if (meshes.size() == 0) {
+        return {};
+    }
+    return meshes[0]["compress_vertices"].as<bool>();
+}
+
+// Octahedral encoding of a unit vector as two snorm16.
+static uint32_t encode_octahedral(Vec3 p_vector) {
+    const float length = std::abs(p_vector.x) + std::abs(p_vector.y) + std::abs(p_vector.z);
+    if (length == 0.0f) {
+        return glm::packSnorm2x16(Vec2(0.0f));
+    }
+    Vec2 encoded = Vec2(p_vector) / length;
+    if (p_vector.z < 0.0f) {
+        const Vec2 signs(encoded.x >= 0.0f ? 1.0f : -1.0f, encoded.y >= 0.0f ? 1.0f : -1.0f);
+        encoded = (1.0f - glm::abs(Vec2(encoded.y, encoded.x))) * signs;
+    }
+    return glm::packSnorm2x16(encoded);
+}
+
+// Quantizes positions to 16 bits within the bounds of the mesh.
+static std::vector<CompressedVertex> compress_vertices(std::span<const Vertex> p_vertices, ImportedVertexQuantization& r_quantization) {
+    Vec3 min(std::numeric_limits<float>::max());
+    Vec3 max(std::numeric_limits<float>::lowest());
+    for (const Vertex& vertex : p_vertices) {
+        min = glm::min(min, vertex.position);
+        max = glm::max(max, vertex.position);
+    }
+    // Flat meshes still get a scale that doesn't divide by zero.
+    const Vec3 scale = glm::max(max - min, Vec3(1.0e-6f)) / 65535.0f;
+    r_quantization = ImportedVertexQuantization {
+        .position_offset = { min.x, min.y, min.z },
+        .position_scale = { scale.x, scale.y, scale.z },
+    };
+
+    std::vector<CompressedVertex> compressed(p_vertices.size());
+    for (size_t index = 0; index < p_vertices.size(); index++) {
+        const Vertex& vertex = p_vertices[index];
+        const Vec3 position = glm::clamp(glm::round((vertex.position - min) / scale), 0.0f, 65535.0f);
+        compressed[index] = CompressedVertex {
+            .position = { uint16_t(position.x), uint16_t(position.y), uint16_t(position.z) },
+            .tangent_sign = uint16_t(vertex.tangent.w < 0.0f),
+            .normal = encode_octahedral(vertex.normal),
+            .tangent = encode_octahedral(Vec3(vertex.tangent)),
+            .uv = glm::packHalf2x16(Vec2(vertex.uv_x, vertex.uv_y)),
+            .color = glm::packUnorm4x8(vertex.color),
+        };
+    }
+    return compressed;
+}
+
+static void cook_collision_shape(const ImportedMeshData& p_data, const std::string& p_path) {
+    const auto& vertices = p_data.vertices;
+    const auto& indices = p_data.indices;
+    JPH::TriangleList triangles;
+    triangles.reserve(indices.size() * 3);
+    for (uint triangle_id = 0; triangle_id + 3 < indices.size(); triangle_id += 3) {
+        JPH::Vec3 v1(vertices[indices[triangle_id]].position.x,     vertices[indices[triangle_id]].position.y,     vertices[indices[triangle_id]].position.z);
+        JPH::Vec3 v2(vertices[indices[triangle_id + 1]].position.x, vertices[indices[triangle_id + 1]].position.y, vertices[indices[triangle_id + 1]].position.z);
+        JPH::Vec3 v3(vertices[indices[triangle_id + 2]].position.x, vertices[indices[triangle_id + 2]].position.y, vertices[indices[triangle_id + 2]].position.z);
+        triangles.emplace_back(JPH::Triangle(v1, v2, v3, 0));
+    }
+    JPH::PhysicsMaterialList mats;
+    mats.push_back(JPH::PhysicsMaterial::sDefault);
+    auto shape = (new JPH::MeshShapeSettings(triangles, mats))->Create().Get();
+
+    std::ofstream collision_file(p_path, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+    JPH::StreamOutWrapper stream_out(collision_file);
+    JPH::Shape::ShapeToIDMap shape_to_id;
+    JPH::Shape::MaterialToIDMap material_to_id;
+    uint FOURCC_JOLT = 42;
+    stream_out.Write(FOURCC_JOLT);
+    shape->SaveBinaryState(stream_out);
+    collision_file.flush();
+    collision_file.close();
+    if (stream_out.IsFailed()) {
+        std::println("FAIL");
+    }
+}
+
+void import_gltf_scene(Renderer* p_renderer, std::filesystem::path p_file_path, std::optional<bool> p_compress_vertices) {
     print("Importing GLTF: %s", p_file_path.c_str());
+    const auto import_start = std::chrono::steady_clock::now();
     auto target_path = std::format("{}.imported", p_file_path.c_str());
-    std::fstream file(target_path.c_str() , std::fstream::out | std::fstream::binary);
+    // Written out at the end, behind the mesh id that is hashed from it.
+    ImportedModel model;
+    std::filesystem::create_directories(CONTENT_CACHE_DIRECTORY);
     
     constexpr auto gltf_options = fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble | fastgltf::Options::LoadExternalBuffers;
     auto data = fastgltf::GltfDataBuffer::FromPath(p_file_path);
@@ -253,195 +985,64 @@ void import_gltf_scene(Renderer* p_renderer, std::filesystem::path p_file_path)
         return;
     }
 
-    std::vector<SamplerCreateInfo> sampler_infos;
     for (fastgltf::Sampler& sampler : asset.samplers) {
-        sampler_infos.emplace_back(SamplerCreateInfo {
-            .magFilter = extract_filter(sampler.magFilter.value_or(fastgltf::Filter::Nearest)),
-            .minFilter = extract_filter(sampler.minFilter.value_or(fastgltf::Filter::Nearest)),
-            .mipmapMode = extract_mipmap_mode(sampler.minFilter.value_or(fastgltf::Filter::Nearest)),
-            .addressModeU = extract_address_mode(sampler.wrapS),
-            .addressModeV = extract_address_mode(sampler.wrapT),
-            .minLod = 0,
-            .maxLod = LodClampNone,
+        model.samplers.emplace_back(ImportedSampler {
+            .mag_filter = extract_filter(sampler.magFilter.value_or(fastgltf::Filter::Nearest)),
+            .min_filter = extract_filter(sampler.minFilter.value_or(fastgltf::Filter::Nearest)),
+            .mipmap_mode = extract_mipmap_mode(sampler.minFilter.value_or(fastgltf::Filter::Nearest)),
+            .address_mode_u = extract_address_mode(sampler.wrapS),
+            .address_mode_v = extract_address_mode(sampler.wrapT),
         });
     }
-
-    file << "Samplers\n";
-    file << sampler_infos.size() << "\n";
-    file.write((char*)sampler_infos.data(), sampler_infos.size() * sizeof(SamplerCreateInfo));
     
-    // Textures
-    file << "Textures\n";
-    file << asset.images.size() << "\n";
-    for (auto image : asset.images) {
-        std::visit(
-            fastgltf::visitor {
-                [](auto& argument) {},
-                [&](fastgltf::sources::URI& file_path) {
-                    assert(file_path.fileByteOffset == 0);
-                    assert(file_path.uri.isLocalPath());
-                    auto full_path = p_file_path.parent_path().string() + "/" + file_path.uri.c_str();
-                    auto ktx_path = std::format("{}.{}", full_path, "ktx2");
-                    if (std::filesystem::exists(ktx_path)) {
-                        full_path = ktx_path;
-                    } else {
-                        VkFormat format;
-                        bool format_specified = false;
-                        for (auto texture : import_settings["Textures"]) {
-                            if (texture["name"].as<std::string>() == image.name.c_str()) {
-                                format = texture["sRGB"].as<bool>() ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
-                                format_specified = true;
-                            }
-                        }
-                        if (!format_specified) {
-                            format = VK_FORMAT_R8G8B8A8_UNORM;
-                            YAML::Node texture_node {};
-                            texture_node["name"] = image.name.c_str();
-                            texture_node["sRGB"] = false;
-                            import_settings["Textures"].push_back(texture_node);
-                        }
-
-                        int width, height, number_channels;
-                        unsigned char* data = stbi_load(full_path.c_str(), &width, &height, &number_channels, 4);
-                        if (data == nullptr) {
-                            return;
-                        }
-                        ktxTexture2* texture;
-                        KTX_error_code result;
-                        ktx_uint32_t level, layer, face_slice;
-                        level = layer = face_slice = 0;
-                        ktxTextureCreateInfo ktx_info {
-                            .vkFormat = format,
-                            .baseWidth = (ktx_uint32_t)width,
-                            .baseHeight = (ktx_uint32_t)height,
-                            .baseDepth = 1,
-                            .numDimensions = 2,
-                            .numLevels = (ktx_uint32_t)1,//(std::log2(width) + 1),
-                            .numLayers = (ktx_uint32_t)1,
-                            .numFaces = (ktx_uint32_t)1,
-                            .isArray = KTX_FALSE,
-                            .generateMipmaps = KTX_TRUE,
-                        };
-                        result = ktxTexture2_Create(&ktx_info, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &texture);
-                        texture->pData = static_cast<uint8_t*>(data);
-
-                        auto texture_path = std::format("{}/{}.ktx2", p_file_path.parent_path().c_str(), image.name.c_str());
-                        ktxTexture_WriteToNamedFile(ktxTexture(texture), texture_path.c_str());
-                        texture->pData = nullptr;
-                        stbi_image_free(data);
-                    }
-                    file << full_path << "\n";
-                },
-                [&](fastgltf::sources::Array& array) {
-                    // TODO
-                    file << "-1";
-                },
-                [&](fastgltf::sources::BufferView& view) {
-                    // TODO
-                    auto& buffer_view = asset.bufferViews[view.bufferViewIndex];
-                    auto& buffer = asset.buffers[buffer_view.bufferIndex];
-                    std::visit(
-                        fastgltf::visitor {
-                            [](auto& argument) {},
-                            [&](fastgltf::sources::Array& array) {
-                                VkFormat format;
-                                bool format_specified = false;
-                                for (auto texture : import_settings["Textures"]) {
-                                    if (texture["name"].as<std::string>() == image.name.c_str()) {
-                                        format = texture["sRGB"].as<bool>() ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
-                                        format_specified = true;
-                                    }
-                                }
-                                if (!format_specified) {
-                                    format = VK_FORMAT_R8G8B8A8_UNORM;
-                                    YAML::Node texture_node {};
-                                    texture_node["name"] = image.name.c_str();
-                                    texture_node["sRGB"] = false;
-                                    import_settings["Textures"].push_back(texture_node);
-                                }
-
-                                int width, height, number_channels;
-                                unsigned char* data = stbi_load_from_memory((stbi_uc*)array.bytes.data() + buffer_view.byteOffset, static_cast<int>(buffer_view.byteLength), &width, &height, &number_channels, 4);
-                                if (data == nullptr) {
-                                    return;
-                                }
-                                ktxTexture2* texture;
-                                KTX_error_code result;
-                                ktx_uint32_t level, layer, face_slice;
-                                level = layer = face_slice = 0;
-                                ktxTextureCreateInfo ktx_info {
-                                    .vkFormat = format,
-                                    .baseWidth = (ktx_uint32_t)width,
-                                    .baseHeight = (ktx_uint32_t)height,
-                                    .baseDepth = 1,
-                                    .numDimensions = 2,
-                                    .numLevels = (ktx_uint32_t)1,//(std::log2(width) + 1),
-                                    .numLayers = (ktx_uint32_t)1,
-                                    .numFaces = (ktx_uint32_t)1,
-                                    .isArray = KTX_FALSE,
-                                    .generateMipmaps = KTX_TRUE,
-                                };
-                                result = ktxTexture2_Create(&ktx_info, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &texture);
-                                texture->pData = static_cast<uint8_t*>(data);
-
-                                auto texture_path = std::format("{}/{}.ktx2", p_file_path.parent_path().c_str(), image.name.c_str());
-                                ktxTexture_WriteToNamedFile(ktxTexture(texture), texture_path.c_str());
-                                texture->pData = nullptr;
-                                stbi_image_free(data);
-                                file << texture_path << "\n";
-                            }
-                        }, buffer.data
-                    );
-                },
-            }, image.data
-        );
+    // Textures, one entry per image, left invalid where it couldn't be imported.
+    // The settings are looked up first, the jobs don't touch them.
+    std::vector<bool> normal_maps(asset.images.size(), false);
+    for (const fastgltf::Material& material : asset.materials) {
+        if (material.normalTexture.has_value()) {
+            const auto& image_index = asset.textures[material.normalTexture.value().textureIndex].imageIndex;
+            if (image_index.has_value()) {
+                normal_maps[image_index.value()] = true;
+            }
+        }
+    }
+    std::vector<TextureImportSettings> image_settings;
+    for (size_t image_index = 0; image_index < asset.images.size(); image_index++) {
+        image_settings.push_back(get_texture_settings(import_settings, asset.images[image_index].name.c_str(), normal_maps[image_index]));
+    }
+    std::vector<ImportedImageResult> images(asset.images.size());
+    parallel_for(asset.images.size(), [&](size_t p_index) {
+        images[p_index] = import_image(asset, asset.images[p_index], p_file_path, image_settings[p_index]);
+    });
+    for (const auto& image : images) {
+        model.textures.push_back(ImportedTexture { image.id, model.add_string(image.cache_path) });
     }
 
     // Materials
-    file << "Materials\n";
-    file << asset.materials.size() << "\n";
-    uint32_t data_index = 0;
-    for (fastgltf::Material& temp_material : asset.materials) {
-        
-        file << (float)temp_material.pbrData.baseColorFactor[0] << "\n";
-        file << (float)temp_material.pbrData.baseColorFactor[1] << "\n";
-        file << (float)temp_material.pbrData.baseColorFactor[2] << "\n";
-        file << (float)temp_material.pbrData.baseColorFactor[3] << "\n";
-        file << (float)temp_material.pbrData.metallicFactor << "\n";
-        file << (float)temp_material.pbrData.roughnessFactor << "\n";
-
-        if (temp_material.pbrData.baseColorTexture.has_value()) {
-            size_t image_index   = asset.textures[temp_material.pbrData.baseColorTexture.value().textureIndex].imageIndex.value();
-            size_t sampler_index = asset.textures[temp_material.pbrData.baseColorTexture.value().textureIndex].samplerIndex.value();
-
-            file << image_index << "\n";
-            file << sampler_index << "\n";
-        } else {
-            file << -1 << "\n";
-            file << -1 << "\n";
-        }
-
-        if (temp_material.normalTexture.has_value()) {
-            size_t image_index   = asset.textures[temp_material.normalTexture.value().textureIndex].imageIndex.value();
-            size_t sampler_index = asset.textures[temp_material.normalTexture.value().textureIndex].samplerIndex.value();
-
-            file << image_index << "\n";
-            file << sampler_index << "\n";
-        } else {
-            file << -1 << "\n";
-            file << -1 << "\n";
-        }
-
-        if (temp_material.pbrData.metallicRoughnessTexture.has_value()) {
-            size_t image_index   = asset.textures[temp_material.pbrData.metallicRoughnessTexture.value().textureIndex].imageIndex.value();
-            size_t sampler_index = asset.textures[temp_material.pbrData.metallicRoughnessTexture.value().textureIndex].samplerIndex.value();
-
-            file << image_index << "\n";
-            file << sampler_index << "\n";
-        } else {
-            file << -1 << "\n";
-            file << -1 << "\n";
+    // Image and sampler index of a texture slot, -1 for empty slots.
+    auto get_texture_indices = [&](const auto& p_texture_info, int32_t& r_image, int32_t& r_sampler) {
+        r_image = r_sampler = -1;
+        if (p_texture_info.has_value()) {
+            const fastgltf::Texture& texture = asset.textures[p_texture_info.value().textureIndex];
+            r_image = int32_t(texture.imageIndex.value());
+            r_sampler = int32_t(texture.samplerIndex.value());
         }
+    };
+    for (fastgltf::Material& temp_material : asset.materials) {
+        ImportedMaterial material {
+            .albedo_factors = {
+                (float)temp_material.pbrData.baseColorFactor[0],
+                (float)temp_material.pbrData.baseColorFactor[1],
+                (float)temp_material.pbrData.baseColorFactor[2],
+                (float)temp_material.pbrData.baseColorFactor[3],
+            },
+            .metallic = (float)temp_material.pbrData.metallicFactor,
+            .roughness = (float)temp_material.pbrData.roughnessFactor,
+        };
+        get_texture_indices(temp_material.pbrData.baseColorTexture, material.albedo_image, material.albedo_sampler);
+        get_texture_indices(temp_material.normalTexture, material.normal_image, material.normal_sampler);
+        get_texture_indices(temp_material.pbrData.metallicRoughnessTexture, material.metal_roughness_image, material.metal_roughness_sampler);
+        model.materials.push_back(material);
     }
 
     // Skin
@@ -472,246 +1073,135 @@ void import_gltf_scene(Renderer* p_renderer, std::filesystem::path p_file_path)
     }
 
     // Animations
-    file << "Animations\n";
-    file << asset.animations.size() << "\n";
-    AnimationLibrary animation_library;
-    if (!asset.animations.empty()) {
-        for (auto& gltf_animation : asset.animations) {
-            file << gltf_animation.name.c_str() << "\n";
-            float animation_length = 0.0f;
-            std::unordered_map<uint32_t, AnimationChannel> channels;
-            for (auto gltf_channel : gltf_animation.channels) {
-                auto animation_sampler = gltf_animation.samplers[gltf_channel.samplerIndex];
-                auto input_accessor = asset.accessors[animation_sampler.inputAccessor];
-                auto output_accessor = asset.accessors[animation_sampler.outputAccessor];
-                if (channels.find(gltf_channel.nodeIndex.value()) == channels.end()) {
-                    channels[gltf_channel.nodeIndex.value()] = AnimationChannel {};
-                }
-                auto channel = &channels[gltf_channel.nodeIndex.value()];
-                if (gltf_channel.path == fastgltf::AnimationPath::Translation) {
-                    fastgltf::iterateAccessorWithIndex<float>(asset, input_accessor,
-                        [&](float p_time, size_t index) {
-                            animation_length = std::max(animation_length, p_time);
-                            KeyframePosition keyframe;
-                            keyframe.time = p_time;
-                            channel->position_keyframes.push_back(keyframe);
-                        }
-                    );
-                    fastgltf::iterateAccessorWithIndex<Vec3>(asset, output_accessor,
-                        [&](Vec3 p_position, size_t index) {
-                            channel->position_keyframes[index].position = p_position;
-                        }
-                    );
-                } else if (gltf_channel.path == fastgltf::AnimationPath::Rotation) {
-                    fastgltf::iterateAccessorWithIndex<float>(asset, input_accessor,
-                        [&](float p_time, size_t index) {
-                            animation_length = std::max(animation_length, p_time);
-                            KeyframeRotation keyframe;
-                            keyframe.time = p_time;
-                            channel->rotation_keyframes.push_back(keyframe);
-                        }
-                    );
-                    fastgltf::iterateAccessorWithIndex<Vec4>(asset, output_accessor,
-                        [&](Vec4 p_rotation, size_t index) {
-                            channel->rotation_keyframes[index].rotation = Quaternion(p_rotation[3], p_rotation[0], p_rotation[1], p_rotation[2]);
-                        }
-                    );
-                }
+    std::vector<ImportedAnimationResult> animations(asset.animations.size());
+    parallel_for(asset.animations.size(), [&](size_t p_index) {
+        animations[p_index] = import_animation(asset, asset.animations[p_index]);
+    });
+    for (size_t animation_index = 0; animation_index < animations.size(); animation_index++) {
+        const auto& animation = animations[animation_index];
+        model.animations.push_back(ImportedAnimation {
+            .name = model.add_string(asset.animations[animation_index].name.c_str()),
+            .length = animation.length,
+            .first_channel = uint32_t(model.channels.size()),
+            .channel_count = uint32_t(animation.channels.size()),
+        });
+        for (auto& kv : animation.channels) {
+            model.channels.push_back(ImportedChannel {
+                .node_index = kv.first,
+                .first_position = uint32_t(model.position_keys.size()),
+                .position_count = uint32_t(kv.second.position_keyframes.size()),
+                .first_rotation = uint32_t(model.rotation_keys.size()),
+                .rotation_count = uint32_t(kv.second.rotation_keyframes.size()),
+            });
+            for (auto& keyframe : kv.second.position_keyframes) {
+                model.position_keys.push_back(ImportedPositionKey {
+                    keyframe.time,
+                    { keyframe.position.x, keyframe.position.y, keyframe.position.z },
+                });
             }
-            file << animation_length << "\n";
-            file << channels.size() << "\n";
-            for (auto& kv : channels) {
-                file << kv.first << "\n"; // node index
-                file << kv.second.position_keyframes.size() << "\n";
-                for (auto& keyframe : kv.second.position_keyframes) {
-                    file << keyframe.time << "\n";
-                    file << keyframe.position.x << "\n";
-                    file << keyframe.position.y << "\n";
-                    file << keyframe.position.z << "\n";
-                }
-                file << kv.second.rotation_keyframes.size() << "\n";
-                for (auto& keyframe : kv.second.rotation_keyframes) {
-                    file << keyframe.time << "\n";
-                    file << keyframe.rotation.x << "\n";
-                    file << keyframe.rotation.y << "\n";
-                    file << keyframe.rotation.z << "\n";
-                    file << keyframe.rotation.w << "\n";
-                }
+            for (auto& keyframe : kv.second.rotation_keyframes) {
+                model.rotation_keys.push_back(ImportedRotationKey {
+                    keyframe.time,
+                    { keyframe.rotation.x, keyframe.rotation.y, keyframe.rotation.z, keyframe.rotation.w },
+                });
             }
         }
     }
 
-    // Meshes
-    std::vector<uint32_t> indices;
-    std::vector<Vertex> vertices;
-    std::vector<SkinningData> skinning_data;
-
-    for (fastgltf::Mesh& mesh : asset.meshes) {
-        indices.clear();
-        vertices.clear();
-        skinning_data.clear();
-
-        auto mesh_name = mesh.name;
-        bool generate_collision_shape = mesh_name.ends_with("_col");
-        for (auto&& primitive : mesh.primitives) {
-            // Surfaces
-            MeshSurface new_surface;
-            new_surface.start_index = (uint32_t) indices.size();
-            new_surface.count = (uint32_t) asset.accessors[primitive.indicesAccessor.value()].count;
-
-            // Vertices and indices
-            size_t initial_vertex_index = vertices.size();
-
-            // Indices
-            {
-                fastgltf::Accessor& index_accessor = asset.accessors[primitive.indicesAccessor.value()];
-                indices.reserve(indices.size() + index_accessor.count);
-                fastgltf::iterateAccessor<std::uint32_t>(asset, index_accessor,
-                    [&](std::uint32_t index) {
-                        indices.push_back(initial_vertex_index + index);
-                    }
-                );
-            }
-
-            // Positions
-            {
-                fastgltf::Accessor& position_accessor = asset.accessors[primitive.findAttribute("POSITION")->accessorIndex];
-                vertices.resize(vertices.size() + position_accessor.count);
-
-                fastgltf::iterateAccessorWithIndex<glm::vec3>(asset, position_accessor,
-                    [&](glm::vec3 vector, size_t index) {
-                        Vertex new_vertex {
-                            .position = vector,
-                            .uv_x = 0.0f,
-                            .normal = { 1.0f, 0.0f, 0.0f },
-                            .uv_y = 0.0f,
-                            .color = Vec4(1.0f),
-                        };
-                        vertices[initial_vertex_index + index] = new_vertex;
-                    }
-                );
-            }
-
-            // Normals
-            auto normals = primitive.findAttribute("NORMAL");
-            if (normals != primitive.attributes.end()) {
-                fastgltf::iterateAccessorWithIndex<Vec3>(asset, asset.accessors[(*normals).accessorIndex],
-                    [&](Vec3 normal, size_t index) {
-                        vertices[initial_vertex_index + index].normal = glm::normalize(normal);
-                    }
-                );
-            }
-
-            // Tangents
-            auto tangents = primitive.findAttribute("TANGENT");
-            if (tangents != primitive.attributes.end()) {
-                fastgltf::iterateAccessorWithIndex<Vec4>(asset, asset.accessors[(*tangents).accessorIndex],
-                    [&](Vec4 tangent, size_t index) {
-                        vertices[initial_vertex_index + index].tangent = tangent;
-                    }
-                );
-            }
-
-            // UV
-            auto tex_coord = primitive.findAttribute("TEXCOORD_0");
-            if (tex_coord != primitive.attributes.end()) {
-                fastgltf::iterateAccessorWithIndex<Vec2>(asset, asset.accessors[(*tex_coord).accessorIndex],
-                    [&](Vec2 uv, size_t index) {
-                        vertices[initial_vertex_index + index].uv_x = uv.x;
-                        vertices[initial_vertex_index + index].uv_y = uv.y;
-                    }
-                );
-            }
-
-            // Color
-            auto color_attribute = primitive.findAttribute("COLOR_1");
-            if (color_attribute != primitive.attributes.end()) {
-                fastgltf::iterateAccessorWithIndex<Vec4>(asset, asset.accessors[(*color_attribute).accessorIndex],
-                    [&](Vec4 color, size_t index) {
-                        vertices[initial_vertex_index + index].color = color;
-                    }
-                );
-            }
-            
-            // Joints
-            auto joint_attribute = primitive.findAttribute(std::format("JOINTS_{}", 0));
-            if (joint_attribute != primitive.attributes.end()) {
-                skinning_data.resize(vertices.size());
-                fastgltf::Accessor& joint_accessor = asset.accessors[joint_attribute->accessorIndex];
-                fastgltf::iterateAccessorWithIndex<Vec4>(asset, joint_accessor,
-                    [&](Vec4 joint, size_t index) {
-                        skinning_data[initial_vertex_index + index] = SkinningData {
-                            .joint_ids = {
-                                uint32_t(asset.skins[0].joints[uint32_t(joint.x)]),
-                                uint32_t(asset.skins[0].joints[uint32_t(joint.y)]),
-                                uint32_t(asset.skins[0].joints[uint32_t(joint.z)]),
-                                uint32_t(asset.skins[0].joints[uint32_t(joint.w)]),
-                            }
-                        };
-                    }
-                );
-
-                auto weights_attribute = primitive.findAttribute(std::format("WEIGHTS_{}", 0));
-                assert(weights_attribute != primitive.attributes.end());
-                fastgltf::Accessor& weight_accessor = asset.accessors[weights_attribute->accessorIndex];
-                fastgltf::iterateAccessorWithIndex<Vec4>(asset, weight_accessor,
-                    [&](Vec4 weights, size_t index) {
-                        skinning_data[initial_vertex_index + index].weights = weights;
-                    }
-                );
-            }
+    // Meshes. Only the first one is loaded by ModelData, the others are only
+    // imported for their collision shapes. Each mesh ending in "_col"
+    // writes the same collision file, the last one is kept.
+    size_t collision_mesh_index = asset.meshes.size();
+    for (size_t mesh_index = 0; mesh_index < asset.meshes.size(); mesh_index++) {
+        if (std::string_view(asset.meshes[mesh_index].name).ends_with("_col")) {
+            collision_mesh_index = mesh_index;
+        }
+    }
 
-            file << new_surface.start_index << "\n";
-            file << new_surface.count << "\n";
-            if (primitive.materialIndex.has_value()) {
-                file << primitive.materialIndex.value() << "\n";
-            } else {
-                file << -1 << "\n";
-            }
+    std::vector<ImportedMeshGeometry> geometries(asset.meshes.size());
+    std::vector<PrimitiveJob> primitive_jobs;
+    for (size_t mesh_index = 0; mesh_index < asset.meshes.size(); mesh_index++) {
+        if (mesh_index != 0 && mesh_index != collision_mesh_index) {
+            continue;
         }
+        ImportedMeshGeometry& geometry = geometries[mesh_index];
+        size_t index_count = 0;
+        size_t vertex_count = 0;
+        bool skinned = false;
+        const auto& primitives = asset.meshes[mesh_index].primitives;
+        for (size_t primitive_index = 0; primitive_index < primitives.size(); primitive_index++) {
+            const auto& primitive = primitives[primitive_index];
+            primitive_jobs.push_back(PrimitiveJob { mesh_index, primitive_index, index_count, vertex_count });
+            geometry.first_vertices.push_back(vertex_count);
+            geometry.surfaces.push_back(ImportedSurface {
+                .start_index = uint32_t(index_count),
+                .count = uint32_t(asset.accessors[primitive.indicesAccessor.value()].count),
+                .material_index = primitive.materialIndex.has_value() ? int32_t(primitive.materialIndex.value()) : -1,
+            });
+            index_count += asset.accessors[primitive.indicesAccessor.value()].count;
+            vertex_count += asset.accessors[primitive.findAttribute("POSITION")->accessorIndex].count;
+            skinned |= primitive.findAttribute(std::format("JOINTS_{}", 0)) != primitive.attributes.end();
+        }
+        geometry.first_vertices.push_back(vertex_count);
+        geometry.data.indices.resize(index_count);
+        geometry.data.vertices.resize(vertex_count);
+        if (skinned) {
+            geometry.data.skinning_data.resize(vertex_count);
+        }
+    }
+    parallel_for(primitive_jobs.size(), [&](size_t p_index) {
+        const PrimitiveJob& job = primitive_jobs[p_index];
+        const auto& primitive = asset.meshes[job.mesh_index].primitives[job.primitive_index];
+        import_primitive(asset, primitive, job.first_index, job.first_vertex, geometries[job.mesh_index].data);
+    });
+    bool compress = false;
+    if (!asset.meshes.empty()) {
+        optimize_mesh(geometries[0], asset.meshes[0].name);
+        pack_indices(geometries[0]);
+        compress = get_compress_vertices(import_settings, asset.meshes[0].name.c_str(), p_compress_vertices);
+    }
 
-        if (generate_collision_shape) {
-            JPH::TriangleList triangles;
-            triangles.reserve(indices.size() * 3);
-            for (uint triangle_id = 0; triangle_id + 3 < indices.size(); triangle_id += 3) {
-                JPH::Vec3 v1(vertices[indices[triangle_id]].position.x,     vertices[indices[triangle_id]].position.y,     vertices[indices[triangle_id]].position.z);
-                JPH::Vec3 v2(vertices[indices[triangle_id + 1]].position.x, vertices[indices[triangle_id + 1]].position.y, vertices[indices[triangle_id + 1]].position.z);
-                JPH::Vec3 v3(vertices[indices[triangle_id + 2]].position.x, vertices[indices[triangle_id + 2]].position.y, vertices[indices[triangle_id + 2]].position.z);
-                triangles.emplace_back(JPH::Triangle(v1, v2, v3, 0));
-            }
-            JPH::PhysicsMaterialList mats;
-            mats.push_back(JPH::PhysicsMaterial::sDefault);
-            auto shape = (new JPH::MeshShapeSettings(triangles, mats))->Create().Get();
-
-            std::ofstream collision_file(std::format("{}.col", p_file_path.c_str()), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
-            JPH::StreamOutWrapper stream_out(collision_file);
-            JPH::Shape::ShapeToIDMap shape_to_id;
-            JPH::Shape::MaterialToIDMap material_to_id;
-            uint FOURCC_JOLT = 42;
-            stream_out.Write(FOURCC_JOLT);
-            shape->SaveBinaryState(stream_out);
-            collision_file.flush();
-            collision_file.close();
-            if (stream_out.IsFailed()) {
-                std::println("FAIL");
+    // The collision shape is cooked while the vertex data is stored.
+    std::string blob_path;
+    parallel_for(2, [&](size_t p_index) {
+        if (p_index == 0 && collision_mesh_index < asset.meshes.size()) {
+            cook_collision_shape(geometries[collision_mesh_index].data, std::format("{}.col", p_file_path.c_str()));
+        } else if (p_index == 1 && !asset.meshes.empty()) {
+            // Vertex data goes into the shared cache, identical geometry is
+            // stored once.
+            ImportedMeshData& data = geometries[0].data;
+            data.joint_data = joint_data;
+            if (compress) {
+                // Stored instead of the vertices, the collision shape is
+                // cooked from those meanwhile.
+                data.compressed_vertices = compress_vertices(data.vertices, data.quantization);
             }
+            const std::string blob_data = data.to_bytes();
+            store_in_cache(blob_data.data(), blob_data.size(), ".mesh", blob_path);
         }
-        file << "\n";
-        file << vertices.size() << "\n";
-        file << indices.size() << "\n";
-        file << skinning_data.size() << "\n";
-        file << joint_data.size() << "\n";
-
-        file.write((char*)vertices.data(), vertices.size() * sizeof(Vertex));
-        file.write((char*)indices.data(), indices.size() * sizeof(uint32_t));
-        file.write((char*)skinning_data.data(), skinning_data.size() * sizeof(SkinningData));
-        file.write((char*)joint_data.data(), joint_data.size() * sizeof(JointData));
+    });
+    if (!asset.meshes.empty()) {
+        model.surfaces = std::move(geometries[0].surfaces);
+        model.mesh_blob = model.add_string(blob_path);
     }
 
-    file.close();
+    // The mesh id is hashed from everything above, models that import to the
+    // same content share their mesh on the GPU. Skinned meshes are never
+    // shared, every instance needs a skeleton of its own.
+    const ImportedFileWriter writer = model.to_writer();
+    const ResourceID mesh_id = joint_data.empty()
+        ? writer.get_content_id()
+        : ResourceID::from_name(std::format("{}::/meshes/{}", target_path, "x"));
+    ResourceID::register_name(mesh_id, std::format("{}::/meshes/{}", target_path, "x"));
+    if (!writer.write(target_path, mesh_id)) {
+        print("Could not write %s!", target_path.c_str());
+    }
 
     std::ofstream import_settings_output_stream(import_settings_path.c_str());
     
     import_settings_output_stream << import_settings;
     import_settings_output_stream.close();
+
+    const std::chrono::duration<double, std::milli> import_time = std::chrono::steady_clock::now() - import_start;
+    print("Imported %s in %.1f ms on %u threads", p_file_path.c_str(), import_time.count(), std::max(1u, std::thread::hardware_concurrency()));
 }
@@ -9,7 +9,16 @@
 #include <components/model_data.h>
 
 
-void import_gltf_scene(Renderer* p_renderer, std::filesystem::path p_file_path);
+// Imported textures and vertex data are stored here once, named by the hash
+// of their content, and shared by every model that uses them.
+constexpr const char* CONTENT_CACHE_DIRECTORY = "assets/.cache";
+
+// p_compress_vertices overrides the "compress_vertices" import setting and is
+// written back into it.
+void import_gltf_scene(Renderer* p_renderer, std::filesystem::path p_file_path, std::optional<bool> p_compress_vertices = {});
+
+// The "compress_vertices" import setting p_file_path was last imported with.
+std::optional<bool> get_imported_compress_vertices(const std::filesystem::path& p_file_path);
 
 std::optional<AllocatedImage> load_image(Renderer* p_renderer, std::filesystem::path p_file_path, Format p_format = Format::eR8G8B8A8Unorm);
 
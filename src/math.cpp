@@ -25,3 +25,89 @@ const Transform Transform::operator*(Transform const& rhs) {
     };
 }
 
+
+float AABB::get_surface_area() const {
+    const Vec3 size = max - min;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+bool AABB::contains(const AABB& p_other) const {
+    return min.x <= p_other.min.x && min.y <= p_other.min.y && min.z <= p_other.min.z
+        && max.x >= p_other.max.x && max.y >= p_other.max.y && max.z >= p_other.max.z;
+}
+
+bool AABB::overlaps(const AABB& p_other) const {
+    return min.x <= p_other.max.x && min.y <= p_other.max.y && min.z <= p_other.max.z
+        && max.x >= p_other.min.x && max.y >= p_other.min.y && max.z >= p_other.min.z;
+}
+
+AABB AABB::merge(const AABB& p_other) const {
+    return AABB { glm::min(min, p_other.min), glm::max(max, p_other.max) };
+}
+
+AABB AABB::grow(float p_margin) const {
+    return AABB { min - Vec3(p_margin), max + Vec3(p_margin) };
+}
+
+AABB AABB::transform(const Mat4& p_matrix) const {
+    const Vec3 center  = Vec3(p_matrix * Vec4(get_center(), 1.0f));
+    const Vec3 extents = get_extents();
+    // Extents along each world axis are the absolute projections of the
+    // rotated and scaled box axes.
+    Vec3 world_extents;
+    for (int axis = 0; axis < 3; axis++) {
+        world_extents[axis] = std::abs(p_matrix[0][axis]) * extents.x
+                            + std::abs(p_matrix[1][axis]) * extents.y
+                            + std::abs(p_matrix[2][axis]) * extents.z;
+    }
+    return AABB { center - world_extents, center + world_extents };
+}
+
+bool Sphere::overlaps(const AABB& p_box) const {
+    const Vec3 closest = glm::clamp(center, p_box.min, p_box.max);
+    const Vec3 offset = closest - center;
+    return glm::dot(offset, offset) <= radius * radius;
+}
+
+bool Ray::intersects(const AABB& p_box) const {
+    // Slab test. Division by zero yields infinities, which the comparisons
+    // handle for rays parallel to an axis.
+    const Vec3 inverse = 1.0f / direction;
+    const Vec3 t0 = (p_box.min - origin) * inverse;
+    const Vec3 t1 = (p_box.max - origin) * inverse;
+    const Vec3 t_min = glm::min(t0, t1);
+    const Vec3 t_max = glm::max(t0, t1);
+    const float enter = std::max(std::max(t_min.x, t_min.y), std::max(t_min.z, 0.0f));
+    const float exit  = std::min(std::min(t_max.x, t_max.y), std::min(t_max.z, max_distance));
+    return enter <= exit;
+}
+
+Frustum Frustum::from_matrix(const Mat4& p_view_projection) {
+    // Gribb-Hartmann: the clip space tests -w <= x <= w and -w <= y <= w as
+    // planes built from the rows of the matrix.
+    auto row = [&](int p_row) {
+        return Vec4(p_view_projection[0][p_row], p_view_projection[1][p_row], p_view_projection[2][p_row], p_view_projection[3][p_row]);
+    };
+    Frustum frustum;
+    frustum.planes[0] = row(3) + row(0);
+    frustum.planes[1] = row(3) - row(0);
+    frustum.planes[2] = row(3) + row(1);
+    frustum.planes[3] = row(3) - row(1);
+    for (auto& plane : frustum.planes) {
+        plane /= glm::length(Vec3(plane));
+    }
+    return frustum;
+}
+
+bool Frustum::overlaps(const AABB& p_box) const {
+    const Vec3 center  = p_box.get_center();
+    const Vec3 extents = p_box.get_extents();
+    for (const auto& plane : planes) {
+        const Vec3 normal = Vec3(plane);
+        const float radius = glm::dot(extents, glm::abs(normal));
+        if (glm::dot(normal, center) + plane.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
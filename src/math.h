@@ -32,6 +32,48 @@ struct Transform {
     ~Transform() {}
 };
 
+struct AABB {
+    Vec3 min { 0.0f };
+    Vec3 max { 0.0f };
+
+    Vec3 get_center() const { return (min + max) * 0.5f; }
+    Vec3 get_extents() const { return (max - min) * 0.5f; }
+    float get_surface_area() const;
+
+    bool contains(const AABB& p_other) const;
+    bool overlaps(const AABB& p_other) const;
+    AABB merge(const AABB& p_other) const;
+    AABB grow(float p_margin) const;
+
+    // Bounds of the box after transforming it by p_matrix.
+    AABB transform(const Mat4& p_matrix) const;
+};
+
+struct Sphere {
+    Vec3 center { 0.0f };
+    float radius { 0.0f };
+
+    bool overlaps(const AABB& p_box) const;
+};
+
+struct Ray {
+    Vec3 origin { 0.0f };
+    Vec3 direction { 0.0f, 0.0f, 1.0f };
+    float max_distance { 1.0f };
+
+    bool intersects(const AABB& p_box) const;
+};
+
+struct Frustum {
+    // Inward facing side planes as (normal, distance). The projection uses
+    // reversed depth without a meaningful far plane, and the side planes
+    // already reject everything behind the camera, so depth is not tested.
+    Vec4 planes[4];
+
+    static Frustum from_matrix(const Mat4& p_view_projection);
+    bool overlaps(const AABB& p_box) const;
+};
+
 namespace Math {
     template <typename T> T interpolate(T a, T b, float duration, float delta) {
         return a + (b - a) * (1.0f - std::exp(-delta / duration));
@@ -128,7 +128,8 @@ void Physics::initialize() {
 	JPH::RegisterTypes();
 
 	Physics::temp_allocator = new JPH::TempAllocatorImpl(10 * 1024 * 1024);
-	Physics::job_system = new JPH::JobSystemThreadPool(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, std::thread::hardware_concurrency() - 1);
+	// Shared with the scene update scheduler, hence the extra capacity.
+	Physics::job_system = new JPH::JobSystemThreadPool(2 * JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers + 8, std::thread::hardware_concurrency() - 1);
 
 	physics_system.Init(cMaxBodies, cNumBodyMutexes, cMaxBodyPairs, cMaxContactConstraints, Physics::broad_phase_layer_interface, Physics::object_vs_broadphase_layer_filter, Physics::object_vs_object_layer_filter);
 	physics_system.SetBodyActivationListener(&body_activation_listener);
@@ -13,9 +13,13 @@
 #include <render_flags.h>
 
 #include <core/node.h>
+#include <core/residency.h>
 #include <core/resource.h>
 #include <core/resource_manager.h>
 #include <core/scene_graph.h>
+#include <core/signal.h>
+#include <core/task.h>
+#include <core/transform_store.h>
 
 #include <components/animation_player.h>
 #include <components/bone.h>
@@ -39,6 +43,9 @@
 extern const uint WINDOW_WIDTH = 2560;
 extern const uint WINDOW_HEIGHT = 1440;
 
+// Defined first so they outlive every node.
+TransformStore gTransforms;
+NodeRegistry gNodes;
 SDL_Window* gWindow{ nullptr };
 Renderer gRenderer;
 PerformanceStats gStats {};
@@ -81,7 +88,6 @@ namespace prosper {
         }
 
         Input::process_event(*event);
-        scene.root->process_input(*event);
 
         return true;
     }
@@ -101,14 +107,13 @@ namespace prosper {
                 return false;
             }
         }
+        Input::flush();
 
         scene.update(gStats.frametime / 1000.0f);
-
-        accumulated_time += (gStats.frametime / 1000.0f);
-        while (accumulated_time >= fixed_timestep) {
-            Physics::update(fixed_timestep);
-            accumulated_time -= fixed_timestep;
-        }
+        SignalBase::flush_deferred();
+        scene.commands.apply();
+        prosper::TaskScheduler::poll();
+        Residency::update(gRenderer.get_gpu_memory_budget());
         
         if (gRenderer.resize_requested || true) {
             gRenderer.recreate_swapchain();
@@ -132,9 +137,25 @@ namespace prosper {
             ImGui::Text("FPS:         %f", std::floor(1000.0f / gStats.frametime));
             ImGui::Text("Frametime:   %f ms", gStats.frametime);
             ImGui::Text("Draw time:   %f ms", gStats.mesh_draw_time);
+            ImGui::Text("GPU skinning: %f ms", gStats.gpu_skinning_time);
+            ImGui::Text("GPU geometry: %f ms", gStats.gpu_geometry_time);
             ImGui::Text("Update time: %f ms", gStats.scene_update_time);
+            for (uint32_t phase = 0; phase < UPDATE_PHASE_COUNT; phase++) {
+                ImGui::Text("  %-12s %f ms", UpdateScheduler::get_phase_name(UpdatePhase(phase)), gStats.update_phase_times[phase]);
+            }
             ImGui::Text("Triangles:   %i", gStats.triangle_count);
             ImGui::Text("Draw calls:  %i", gStats.drawcall_count);
+            ImGui::Text("Nodes:       %zu", gNodes.size());
+            ImGui::Text("Loading:     %zu resources", ResourceManager::get_pending_count());
+            ImGui::Text("GPU memory:  %.1f / %.1f MiB", Residency::gpu_memory.usage / 1048576.0, Residency::effective_gpu_budget / 1048576.0);
+            ImGui::Text("Cached:      %zu resources, %.1f MiB GPU, %.1f / %.1f MiB CPU, %zu evicted", Residency::cached_count, Residency::cached_gpu_size / 1048576.0, Residency::cached_cpu_size / 1048576.0, Residency::cpu_budget / 1048576.0, Residency::evictions);
+            ImGui::Text("Meshes:      %zu visible, %zu proxies, tree height %d", scene.visible_mesh_count, scene.spatial.size(), scene.spatial.get_height());
+            ImGui::Text("Spatial:     %zu nodes visited, %zu reinsertions", scene.spatial.nodes_visited, scene.spatial.reinsertions);
+            ImGui::Text("Ticks:       %zu skipped by LOD", ComponentPoolBase::skipped_ticks.exchange(0));
+            scene.spatial.nodes_visited = 0;
+            scene.spatial.reinsertions = 0;
+            ImGui::Text("Slab chunks: %zu allocated, %zu released, %zu blocks live", SlabPool::chunk_allocations, SlabPool::chunk_releases, SlabPool::live_blocks);
+            ImGui::Text("Pool chunks: %zu allocated, %zu released", ComponentPoolBase::chunk_allocations, ComponentPoolBase::chunk_releases);
         }
         ImGui::End();
 
@@ -179,7 +200,9 @@ namespace prosper {
         engine_running = false;
       //  physics_worker.join();
         gRenderer.device.waitIdle();
+        prosper::TaskScheduler::shutdown();
         scene.cleanup();
+        Residency::clear();
         gRenderer.cleanup();
         Physics::cleanup();
     }
@@ -246,6 +269,16 @@ namespace prosper {
         Input::initialize();
         Physics::initialize();
 
+        scene.scheduler.job_system = Physics::job_system;
+        scene.scheduler.add_callback(UpdatePhase::Physics, [](double delta) {
+            accumulated_time += delta;
+            while (accumulated_time >= fixed_timestep) {
+                Physics::update(fixed_timestep);
+                accumulated_time -= fixed_timestep;
+            }
+        });
+        scene.scheduler.add_callback(UpdatePhase::PrePhysics, Collectible::update_triggers);
+
         // Initialize scene
         scene.root = Node::create("root");
 
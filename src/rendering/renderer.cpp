@@ -5,6 +5,7 @@
 #include <components/camera.h>
 #include <core/node.h>
 #include <core/scene_graph.h>
+#include <core/transform_store.h>
 #include <core/resource.h>
 #include <core/resource_manager.h>
 #include <resources/texture.h>
@@ -25,6 +26,7 @@ extern const uint WINDOW_HEIGHT;
 extern PerformanceStats gStats;
 extern vk::SampleCountFlagBits gSamples;
 extern SceneGraph scene;
+extern TransformStore gTransforms;
 
 VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
 
@@ -87,6 +89,14 @@ bool Renderer::create_device() {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME,
         VK_EXT_SHADER_OBJECT_EXTENSION_NAME,
     };
+    // Optional, gives the allocator the actual memory budget.
+    auto [extensions_result, available_extensions] = physical_device.enumerateDeviceExtensionProperties();
+    for (const auto& extension : available_extensions) {
+        if (std::string_view(extension.extensionName) == VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) {
+            enabled_extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+            memory_budget_supported = true;
+        }
+    }
     DeviceQueueCreateInfo queue_create_info {
         .queueFamilyIndex = graphics_queue_index,
         .queueCount = 1,
@@ -141,6 +151,9 @@ bool Renderer::create_allocator() {
         .device         = device,
         .instance       = instance,
     };
+    if (memory_budget_supported) {
+        allocator_info.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
     VkResult result = vmaCreateAllocator(&allocator_info, &allocator);
     deletion_queue.push_function([&]() {
         vmaDestroyAllocator(allocator);
@@ -555,8 +568,13 @@ bool Renderer::create_commands() {
     if (result != Result::eSuccess) { return false; }
     immediate_command_buffer = buffers[0];
 
+    // Upload commands, allocated per upload
+    std::tie(result, upload_command_pool) = device.createCommandPool(create_info);
+    if (result != Result::eSuccess) { return false; }
+
     deletion_queue.push_function([this]() {
         device.destroyCommandPool(immediate_command_pool);
+        device.destroyCommandPool(upload_command_pool);
     });
 
     return true;
@@ -580,7 +598,15 @@ bool Renderer::create_sync_objects() {
         
         std::tie(result, frames[i].render_semaphore) = device.createSemaphore(semaphore_create_info);
         if (result != Result::eSuccess) { return false; }
+
+        QueryPoolCreateInfo query_pool_info {
+            .queryType = QueryType::eTimestamp,
+            .queryCount = TIMESTAMP_COUNT,
+        };
+        std::tie(result, frames[i].timestamp_pool) = device.createQueryPool(query_pool_info);
+        if (result != Result::eSuccess) { return false; }
     }
+    timestamp_period = physical_device.getProperties().limits.timestampPeriod;
 
     std::tie(result, immediate_fence) = device.createFence(fence_create_info);
     deletion_queue.push_function([this]() {
@@ -655,7 +681,7 @@ bool Renderer::create_descriptors() {
 void Renderer::init_default_data() {
     // Default textures
     uint32_t white = glm::packUnorm4x8(glm::vec4(1.0f));
-    auto white_resource = *ResourceManager::get<Texture>("::image_white");
+    auto white_resource = *ResourceManager::get<Texture>(ResourceID::intern("::image_white"));
     image_white = create_image((void*) &white, Extent3D {1, 1, 1}, Format::eR8G8B8A8Unorm, ImageUsageFlagBits::eSampled);
     white_resource->image = std::make_unique<AllocatedImage>(image_white);
     white_resource.set_load_status(LoadStatus::LOADED);
@@ -665,7 +691,7 @@ void Renderer::init_default_data() {
     image_black = create_image((void*) &black, Extent3D {1, 1, 1}, Format::eR8G8B8A8Unorm, ImageUsageFlagBits::eSampled);
 
     uint32_t blue = glm::packUnorm4x8(glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
-    auto default_normal_resource = *ResourceManager::get<Texture>("::image_default_normal");
+    auto default_normal_resource = *ResourceManager::get<Texture>(ResourceID::intern("::image_default_normal"));
     image_default_normal = create_image((void*) &blue, Extent3D {1, 1, 1}, Format::eR8G8B8A8Unorm, ImageUsageFlagBits::eSampled);
     default_normal_resource->image = std::make_unique<AllocatedImage>(image_default_normal);
     default_normal_resource.set_load_status(LoadStatus::LOADED);
@@ -692,11 +718,11 @@ void Renderer::init_default_data() {
     std::tie(result, sampler_default_linear) = device.createSampler(sample_info);
 
     MaterialMetallicRoughness::MaterialResources material_resources {
-        .albedo_texture            = ResourceManager::get<Texture>("::image_white"),
+        .albedo_texture            = ResourceManager::get<Texture>(IMAGE_WHITE),
         .albedo_sampler            = sampler_default_linear,
-        .normal_texture            = ResourceManager::get<Texture>("::image_default_normal"),
+        .normal_texture            = ResourceManager::get<Texture>(IMAGE_DEFAULT_NORMAL),
         .normal_sampler            = sampler_default_nearest,
-        .metal_roughness_texture   = ResourceManager::get<Texture>("::image_white"),
+        .metal_roughness_texture   = ResourceManager::get<Texture>(IMAGE_WHITE),
         .metal_roughness_sampler   = sampler_default_linear,
     };
 
@@ -710,8 +736,11 @@ void Renderer::init_default_data() {
     material_resources.data_buffer_offset = 0;
     default_material = metal_roughness_material.write_material(device, MaterialPass::MainColor, material_resources, global_descriptor_allocator);
 
+    staging_buffer = create_buffer(STAGING_BUFFER_SIZE, BufferUsageFlagBits::eTransferSrc, VMA_MEMORY_USAGE_CPU_ONLY);
+
     deletion_queue.push_function([=, this]() {
         destroy_buffer(material_constants);
+        destroy_buffer(staging_buffer);
 
         destroy_image(image_white);
         destroy_image(image_black);
@@ -816,31 +845,49 @@ AllocatedImage Renderer::create_image(void* p_data, Extent3D p_size, Format p_fo
     AllocatedImage new_image = create_image(p_size, p_format, p_usage | ImageUsageFlagBits::eTransferDst | ImageUsageFlagBits::eTransferSrc, p_mipmapped, p_sample_count);
     
     immediate_submit([&, this](CommandBuffer cmd) {
-        transition_image(cmd, new_image.image, ImageLayout::eUndefined, ImageLayout::eTransferDstOptimal);
-        BufferImageCopy copy_region {
-            .bufferOffset = 0,
-            .bufferRowLength = 0,
-            .bufferImageHeight = 0,
-            .imageSubresource = {
-                .aspectMask = ImageAspectFlagBits::eColor,
-                .mipLevel = 0,
-                .baseArrayLayer = 0,
-                .layerCount = 1,
-            },
-            .imageExtent = p_size,
-        };
+        record_image_upload(cmd, upload_buffer, new_image, p_size, p_mipmapped);
+    });
 
-        cmd.copyBufferToImage(upload_buffer.buffer, new_image.image, ImageLayout::eTransferDstOptimal, 1, &copy_region);
+    destroy_buffer(upload_buffer);
+    return new_image;
+}
 
-        if (p_mipmapped) {
-            generate_mipmaps(cmd, new_image.image, Extent2D {new_image.image_extent.width, new_image.image_extent.height});
-        } else {
-            transition_image(cmd, new_image.image, ImageLayout::eTransferDstOptimal, ImageLayout::eShaderReadOnlyOptimal);
-        }
+prosper::Task<AllocatedImage> Renderer::create_image_async(void* p_data, Extent3D p_size, Format p_format, ImageUsageFlags p_usage, bool p_mipmapped) {
+    size_t data_size = p_size.depth * p_size.width * p_size.height * 4;
+    AllocatedBuffer upload_buffer = create_buffer(data_size, BufferUsageFlagBits::eTransferSrc, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    memcpy(upload_buffer.info.pMappedData, p_data, data_size);
+    AllocatedImage new_image = create_image(p_size, p_format, p_usage | ImageUsageFlagBits::eTransferDst | ImageUsageFlagBits::eTransferSrc, p_mipmapped);
+
+    co_await upload([&, this](CommandBuffer cmd) {
+        record_image_upload(cmd, upload_buffer, new_image, p_size, p_mipmapped);
     });
 
     destroy_buffer(upload_buffer);
-    return new_image;
+    co_return new_image;
+}
+
+void Renderer::record_image_upload(CommandBuffer p_cmd, const AllocatedBuffer& p_source, const AllocatedImage& p_image, Extent3D p_size, bool p_mipmapped) {
+    transition_image(p_cmd, p_image.image, ImageLayout::eUndefined, ImageLayout::eTransferDstOptimal);
+    BufferImageCopy copy_region {
+        .bufferOffset = 0,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource = {
+            .aspectMask = ImageAspectFlagBits::eColor,
+            .mipLevel = 0,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        },
+        .imageExtent = p_size,
+    };
+
+    p_cmd.copyBufferToImage(p_source.buffer, p_image.image, ImageLayout::eTransferDstOptimal, 1, &copy_region);
+
+    if (p_mipmapped) {
+        generate_mipmaps(p_cmd, p_image.image, Extent2D {p_image.image_extent.width, p_image.image_extent.height});
+    } else {
+        transition_image(p_cmd, p_image.image, ImageLayout::eTransferDstOptimal, ImageLayout::eShaderReadOnlyOptimal);
+    }
 }
 
 void Renderer::generate_mipmaps(CommandBuffer p_cmd, Image p_image, Extent2D p_size) {
@@ -922,70 +969,29 @@ void Renderer::destroy_image(const AllocatedImage& p_image) {
     }
 }
 
-GPUMeshBuffers Renderer::upload_mesh(std::span<uint32_t> p_indices, std::span<Vertex> p_vertices, std::span<SkinningData> p_skinning_data, std::span<Mat4> p_joint_matrices) {
-    GPUMeshBuffers new_surface = upload_mesh(p_indices, p_vertices);
-
-    const size_t skinning_data_buffer_size  = p_skinning_data.size() * sizeof(SkinningData);
-    const size_t joint_matrices_buffer_size = p_joint_matrices.size() * sizeof(Mat4);
-
-    // Weights
-    new_surface.skinning_data_buffer = create_buffer(
-        skinning_data_buffer_size,
-        BufferUsageFlagBits::eStorageBuffer | BufferUsageFlagBits::eTransferDst | BufferUsageFlagBits::eShaderDeviceAddress,
-        VMA_MEMORY_USAGE_GPU_ONLY
-    );
-    BufferDeviceAddressInfo device_address_info_skinning_data_buffer {
-        .buffer = new_surface.skinning_data_buffer.buffer,
-    };
-    new_surface.skinning_data_buffer_address = device.getBufferAddress(device_address_info_skinning_data_buffer);
-
-    // Joint matrices
-    new_surface.joint_matrices_buffer = create_buffer(
-        joint_matrices_buffer_size,
-        BufferUsageFlagBits::eStorageBuffer | BufferUsageFlagBits::eTransferDst | BufferUsageFlagBits::eShaderDeviceAddress,
-        VMA_MEMORY_USAGE_CPU_TO_GPU
-    );
-    BufferDeviceAddressInfo device_address_info_joint_matrices_buffer {
-        .buffer = new_surface.joint_matrices_buffer.buffer,
-    };
-    new_surface.joint_matrices_buffer_address = device.getBufferAddress(device_address_info_joint_matrices_buffer);
-
-    // Copy data
-    AllocatedBuffer staging = create_buffer(
-        skinning_data_buffer_size + joint_matrices_buffer_size,
-        BufferUsageFlagBits::eTransferSrc,
-        VMA_MEMORY_USAGE_CPU_ONLY
-    );
-
-    void* data = staging.info.pMappedData;
-
-    memcpy(data, p_skinning_data.data(), skinning_data_buffer_size);
-    memcpy((char*)data + skinning_data_buffer_size, p_joint_matrices.data(), joint_matrices_buffer_size);
-
-    immediate_submit([&](CommandBuffer cmd) {
-        BufferCopy skin_copy {
-            .size = skinning_data_buffer_size,
-        };
-        cmd.copyBuffer(staging.buffer, new_surface.skinning_data_buffer.buffer, 1, &skin_copy);
+GPUMeshBuffers Renderer::upload_mesh(std::span<const std::byte> p_index_data, std::span<const Vertex> p_vertices) {
+    return upload_mesh_data(p_index_data, std::as_bytes(p_vertices), p_vertices.size(), {}, {});
+}
 
-        BufferCopy joint_matrices_copy {
-            .srcOffset = skinning_data_buffer_size,
-            .size      = joint_matrices_buffer_size,
-        };
-        cmd.copyBuffer(staging.buffer, new_surface.joint_matrices_buffer.buffer, 1, &joint_matrices_copy);
-    });
+GPUMeshBuffers Renderer::upload_mesh(std::span<const std::byte> p_index_data, std::span<const Vertex> p_vertices, std::span<const SkinningData> p_skinning_data, std::span<const Mat4> p_joint_matrices) {
+    return upload_mesh_data(p_index_data, std::as_bytes(p_vertices), p_vertices.size(), p_skinning_data, p_joint_matrices);
+}
 
-    destroy_buffer(staging);
+GPUMeshBuffers Renderer::upload_mesh(std::span<const std::byte> p_index_data, std::span<const CompressedVertex> p_vertices) {
+    return upload_mesh_data(p_index_data, std::as_bytes(p_vertices), p_vertices.size(), {}, {});
+}
 
-    return new_surface;
+GPUMeshBuffers Renderer::upload_mesh(std::span<const std::byte> p_index_data, std::span<const CompressedVertex> p_vertices, std::span<const SkinningData> p_skinning_data, std::span<const Mat4> p_joint_matrices) {
+    return upload_mesh_data(p_index_data, std::as_bytes(p_vertices), p_vertices.size(), p_skinning_data, p_joint_matrices);
 }
 
+GPUMeshBuffers Renderer::upload_mesh_data(std::span<const std::byte> p_index_data, std::span<const std::byte> p_vertex_data, size_t p_vertex_count, std::span<const SkinningData> p_skinning_data, std::span<const Mat4> p_joint_matrices) {
+    const size_t vertex_buffer_size = p_vertex_data.size();
+    const size_t index_buffer_size  = p_index_data.size();
+    const bool skinned = !p_skinning_data.empty();
 
-GPUMeshBuffers Renderer::upload_mesh(std::span<uint32_t> p_indices, std::span<Vertex> p_vertices) {
-    const size_t vertex_buffer_size = p_vertices.size() * sizeof(Vertex);
-    const size_t index_buffer_size  = p_indices.size()  * sizeof(uint32_t);
-    
     GPUMeshBuffers new_surface;
+    std::vector<BufferUpload> uploads;
 
     // Index buffer
     new_surface.index_buffer = create_buffer(
@@ -993,6 +999,7 @@ GPUMeshBuffers Renderer::upload_mesh(std::span<uint32_t> p_indices, std::span<Ve
         BufferUsageFlagBits::eIndexBuffer | BufferUsageFlagBits::eTransferDst,
         VMA_MEMORY_USAGE_GPU_ONLY
     );
+    uploads.push_back({ p_index_data.data(), index_buffer_size, new_surface.index_buffer.buffer });
 
     // Original vertex buffer
     new_surface.vertex_buffer = create_buffer(
@@ -1004,10 +1011,19 @@ GPUMeshBuffers Renderer::upload_mesh(std::span<uint32_t> p_indices, std::span<Ve
         .buffer = new_surface.vertex_buffer.buffer,
     };
     new_surface.vertex_buffer_address = device.getBufferAddress(device_address_info_vertex_buffer);
+    uploads.push_back({ p_vertex_data.data(), vertex_buffer_size, new_surface.vertex_buffer.buffer });
 
-    // Skinned vertex buffer
+    if (!skinned) {
+        new_surface.skinned_vertex_buffer_address = new_surface.vertex_buffer_address;
+        upload_buffers(uploads);
+        return new_surface;
+    }
+
+    // Skinned vertex buffer, always Vertex. Compressed vertices are only
+    // decoded into it by the skinning shader.
+    const size_t skinned_vertex_buffer_size = p_vertex_count * sizeof(Vertex);
     new_surface.skinned_vertex_buffer = create_buffer(
-        vertex_buffer_size,
+        skinned_vertex_buffer_size,
         BufferUsageFlagBits::eStorageBuffer | BufferUsageFlagBits::eTransferDst | BufferUsageFlagBits::eShaderDeviceAddress,
         VMA_MEMORY_USAGE_GPU_ONLY
     );
@@ -1015,36 +1031,79 @@ GPUMeshBuffers Renderer::upload_mesh(std::span<uint32_t> p_indices, std::span<Ve
         .buffer = new_surface.skinned_vertex_buffer.buffer,
     };
     new_surface.skinned_vertex_buffer_address = device.getBufferAddress(device_address_info_skinned_vertex_buffer);
+    if (vertex_buffer_size == skinned_vertex_buffer_size) {
+        uploads.push_back({ p_vertex_data.data(), vertex_buffer_size, new_surface.skinned_vertex_buffer.buffer });
+    }
+
+    const size_t skinning_data_buffer_size  = p_skinning_data.size() * sizeof(SkinningData);
+    const size_t joint_matrices_buffer_size = p_joint_matrices.size() * sizeof(Mat4);
 
-    // Copy data
-    AllocatedBuffer staging = create_buffer(
-        vertex_buffer_size + index_buffer_size,
-        BufferUsageFlagBits::eTransferSrc,
-        VMA_MEMORY_USAGE_CPU_ONLY
+    // Weights
+    new_surface.skinning_data_buffer = create_buffer(
+        skinning_data_buffer_size,
+        BufferUsageFlagBits::eStorageBuffer | BufferUsageFlagBits::eTransferDst | BufferUsageFlagBits::eShaderDeviceAddress,
+        VMA_MEMORY_USAGE_GPU_ONLY
     );
+    BufferDeviceAddressInfo device_address_info_skinning_data_buffer {
+        .buffer = new_surface.skinning_data_buffer.buffer,
+    };
+    new_surface.skinning_data_buffer_address = device.getBufferAddress(device_address_info_skinning_data_buffer);
+    uploads.push_back({ p_skinning_data.data(), skinning_data_buffer_size, new_surface.skinning_data_buffer.buffer });
 
-    void* data = staging.info.pMappedData;
+    // Joint matrices
+    new_surface.joint_matrices_buffer = create_buffer(
+        joint_matrices_buffer_size,
+        BufferUsageFlagBits::eStorageBuffer | BufferUsageFlagBits::eTransferDst | BufferUsageFlagBits::eShaderDeviceAddress,
+        VMA_MEMORY_USAGE_CPU_TO_GPU
+    );
+    BufferDeviceAddressInfo device_address_info_joint_matrices_buffer {
+        .buffer = new_surface.joint_matrices_buffer.buffer,
+    };
+    new_surface.joint_matrices_buffer_address = device.getBufferAddress(device_address_info_joint_matrices_buffer);
+    uploads.push_back({ p_joint_matrices.data(), joint_matrices_buffer_size, new_surface.joint_matrices_buffer.buffer });
 
-    memcpy(data, p_vertices.data(), vertex_buffer_size);
-    memcpy((char*)data + vertex_buffer_size, p_indices.data(), index_buffer_size);
+    upload_buffers(uploads);
+    return new_surface;
+}
 
-    immediate_submit([&](CommandBuffer cmd) {
-        BufferCopy vertex_copy {
-            .size      = vertex_buffer_size,
-        };
-        cmd.copyBuffer(staging.buffer, new_surface.vertex_buffer.buffer, 1, &vertex_copy);
-        cmd.copyBuffer(staging.buffer, new_surface.skinned_vertex_buffer.buffer, 1, &vertex_copy);
-        
-        BufferCopy index_copy {
-            .srcOffset = vertex_buffer_size,
-            .size      = index_buffer_size,
-        };
-        cmd.copyBuffer(staging.buffer, new_surface.index_buffer.buffer, 1, &index_copy);
-    });
+void Renderer::upload_buffers(std::span<const BufferUpload> p_uploads) {
+    std::lock_guard lock(staging_mutex);
+    char* staging_data = static_cast<char*>(staging_buffer.info.pMappedData);
+    std::vector<std::pair<Buffer, BufferCopy>> copies;
+    size_t staged_size = 0;
 
-    destroy_buffer(staging);
+    auto submit_copies = [&]() {
+        if (copies.empty()) {
+            return;
+        }
+        immediate_submit([&](CommandBuffer cmd) {
+            for (const auto& [destination, copy] : copies) {
+                cmd.copyBuffer(staging_buffer.buffer, destination, 1, &copy);
+            }
+        });
+        copies.clear();
+        staged_size = 0;
+    };
 
-    return new_surface;
+    // Sources larger than the staging buffer go in pieces.
+    for (const BufferUpload& upload : p_uploads) {
+        size_t uploaded_size = 0;
+        while (uploaded_size < upload.size) {
+            if (staged_size == STAGING_BUFFER_SIZE) {
+                submit_copies();
+            }
+            const size_t chunk_size = std::min(upload.size - uploaded_size, STAGING_BUFFER_SIZE - staged_size);
+            memcpy(staging_data + staged_size, static_cast<const char*>(upload.data) + uploaded_size, chunk_size);
+            copies.emplace_back(upload.destination, BufferCopy {
+                .srcOffset = staged_size,
+                .dstOffset = uploaded_size,
+                .size      = chunk_size,
+            });
+            staged_size += chunk_size;
+            uploaded_size += chunk_size;
+        }
+    }
+    submit_copies();
 }
 
 void Renderer::cleanup_swapchain() {
@@ -1063,6 +1122,7 @@ void Renderer::recreate_swapchain() {
 }
 
 void Renderer::immediate_submit(std::function<void(CommandBuffer p_cmd)>&& function) {
+    std::lock_guard lock(immediate_mutex);
     device.resetFences(1, &immediate_fence);
     immediate_command_buffer.reset();
 
@@ -1085,10 +1145,79 @@ void Renderer::immediate_submit(std::function<void(CommandBuffer p_cmd)>&& funct
         .commandBufferInfoCount = 1,
         .pCommandBufferInfos = &submit_info,
     };
-    graphics_queue.submit2(submit, immediate_fence);
+    {
+        std::lock_guard queue_lock(queue_mutex);
+        graphics_queue.submit2(submit, immediate_fence);
+    }
     device.waitForFences(1, &immediate_fence, True, UINT64_MAX);
 }
 
+prosper::Task<void> Renderer::upload(std::function<void(CommandBuffer p_cmd)> p_record) {
+    Result result;
+    CommandBuffer cmd;
+    {
+        std::lock_guard lock(upload_mutex);
+        CommandBufferAllocateInfo command_alloc_info {
+            .commandPool        = upload_command_pool,
+            .commandBufferCount = 1,
+        };
+        std::vector<CommandBuffer> buffers;
+        std::tie(result, buffers) = device.allocateCommandBuffers(command_alloc_info);
+        if (result != Result::eSuccess) {
+            print("Could not allocate upload command buffer!");
+            co_return;
+        }
+        cmd = buffers[0];
+
+        cmd.begin(CommandBufferBeginInfo { .flags = CommandBufferUsageFlagBits::eOneTimeSubmit });
+        p_record(cmd);
+        cmd.end();
+    }
+
+    Fence fence;
+    std::tie(result, fence) = device.createFence(FenceCreateInfo {});
+    if (result != Result::eSuccess) {
+        print("Could not create upload fence!");
+        co_return;
+    }
+
+    CommandBufferSubmitInfo submit_info {
+        .commandBuffer = cmd,
+    };
+    SubmitInfo2 submit {
+        .commandBufferInfoCount = 1,
+        .pCommandBufferInfos = &submit_info,
+    };
+    {
+        std::lock_guard queue_lock(queue_mutex);
+        graphics_queue.submit2(submit, fence);
+    }
+
+    co_await prosper::wait_until([this, fence]() {
+        return device.getFenceStatus(fence) == Result::eSuccess;
+    });
+
+    device.destroyFence(fence);
+    std::lock_guard lock(upload_mutex);
+    device.freeCommandBuffers(upload_command_pool, 1, &cmd);
+}
+
+MemoryBudget Renderer::get_gpu_memory_budget() {
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(allocator, budgets);
+    const VkPhysicalDeviceMemoryProperties* memory_properties;
+    vmaGetMemoryProperties(allocator, &memory_properties);
+
+    MemoryBudget memory {};
+    for (uint32_t heap = 0; heap < memory_properties->memoryHeapCount; heap++) {
+        if (memory_properties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            memory.usage  += budgets[heap].usage;
+            memory.budget += budgets[heap].budget;
+        }
+    }
+    return memory;
+}
+
 void Renderer::transition_image(CommandBuffer p_cmd, Image p_image, ImageLayout p_current_layout, ImageLayout p_target_layout, ImageAspectFlags p_aspect_flags) {
     ImageAspectFlags aspect_mask;
     if (p_aspect_flags == vk::ImageAspectFlagBits::eNone) {
@@ -1311,6 +1440,7 @@ void Renderer::cleanup() {
         device.destroyFence(frames[i].render_fence);
         device.destroySemaphore(frames[i].swapchain_semaphore);
         device.destroySemaphore(frames[i].render_semaphore);
+        device.destroyQueryPool(frames[i].timestamp_pool);
     }
     metal_roughness_material.clear_resources(device);
     deletion_queue.flush();
@@ -1397,12 +1527,16 @@ void Renderer::draw_geometry(CommandBuffer p_cmd) {
     );
 #endif
 
+    const QueryPool timestamp_pool = get_current_frame().timestamp_pool;
+    p_cmd.resetQueryPool(timestamp_pool, 0, TIMESTAMP_COUNT);
+    p_cmd.writeTimestamp(PipelineStageFlagBits::eTopOfPipe, timestamp_pool, 0);
     for (auto& skinning_push_constants : draw_context.skinned_meshes) {
         skinning_shader.bind(p_cmd);
         skinning_push_constants.time = gStats.time_since_start;
         p_cmd.pushConstants(skinning_shader.layout, ShaderStageFlagBits::eCompute, 0, sizeof(SkinningPushConstants), &skinning_push_constants);
         p_cmd.dispatch(std::ceil(skinning_push_constants.number_vertices / 256.0f), 1, 1);
     }
+    p_cmd.writeTimestamp(PipelineStageFlagBits::eBottomOfPipe, timestamp_pool, 1);
 
     RenderingAttachmentInfo color_attachment_albedo {
         .imageView   = gbuffer_albedo.image_view,
@@ -1434,6 +1568,7 @@ void Renderer::draw_geometry(CommandBuffer p_cmd) {
         .pDepthAttachment = &depth_attachment,
     };
 
+    p_cmd.writeTimestamp(PipelineStageFlagBits::eTopOfPipe, timestamp_pool, 2);
     p_cmd.beginRendering(render_info);
 
     Viewport viewport {
@@ -1452,6 +1587,7 @@ void Renderer::draw_geometry(CommandBuffer p_cmd) {
     MaterialInstance* previous_material = nullptr;
     ShaderObject* previous_shader = nullptr;
     Buffer previous_index_buffer = VK_NULL_HANDLE;
+    IndexType previous_index_type = IndexType::eUint32;
 
     auto draw_object = [&](const RenderObject& render_object) {
         if (render_object.material != previous_material) {
@@ -1465,19 +1601,23 @@ void Renderer::draw_geometry(CommandBuffer p_cmd) {
             p_cmd.bindDescriptorSets(PipelineBindPoint::eGraphics, render_object.material->shader->layout, 0, 1, &render_object.material->material_set, 0, nullptr);
         }
 
-        if (render_object.index_buffer != previous_index_buffer) {
+        if (render_object.index_buffer != previous_index_buffer || render_object.index_type != previous_index_type) {
             previous_index_buffer = render_object.index_buffer;
-            p_cmd.bindIndexBuffer(render_object.index_buffer, 0, IndexType::eUint32);
+            previous_index_type = render_object.index_type;
+            p_cmd.bindIndexBuffer(render_object.index_buffer, 0, render_object.index_type);
         }
         
         get_current_frame().push_constants = {
             .model_matrix = render_object.transform,
             .view_projection = scene_data.view_projection,
             .vertex_buffer_address = render_object.skinned_vertex_buffer_address,
+            .compressed_vertices = render_object.compressed_vertices,
+            .position_offset = render_object.position_offset,
+            .position_scale = render_object.position_scale,
         };
 
         p_cmd.pushConstants(render_object.material->shader->layout, ShaderStageFlagBits::eVertex | ShaderStageFlagBits::eFragment, 0, sizeof(GPUDrawPushConstants), &get_current_frame().push_constants);
-        p_cmd.drawIndexed(render_object.index_count, 1, render_object.first_index, 0, 0);
+        p_cmd.drawIndexed(render_object.index_count, 1, render_object.first_index, render_object.vertex_offset, 0);
 
         gStats.drawcall_count++;
         gStats.triangle_count += render_object.index_count / 3;
@@ -1492,6 +1632,8 @@ void Renderer::draw_geometry(CommandBuffer p_cmd) {
     }
 
     p_cmd.endRendering();
+    p_cmd.writeTimestamp(PipelineStageFlagBits::eBottomOfPipe, timestamp_pool, 3);
+    get_current_frame().timestamps_written = true;
 
     auto end_time = std::chrono::steady_clock::now();
     auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
@@ -1556,12 +1698,30 @@ void Renderer::draw_imgui(CommandBuffer p_cmd, ImageView p_target_image_view) {
     p_cmd.endRendering();
 }
 
+void Renderer::read_timestamps() {
+    FrameData& frame = get_current_frame();
+    if (!frame.timestamps_written) {
+        return;
+    }
+    uint64_t timestamps[TIMESTAMP_COUNT];
+    const Result result = device.getQueryPoolResults(frame.timestamp_pool, 0, TIMESTAMP_COUNT, sizeof(timestamps), timestamps, sizeof(uint64_t), QueryResultFlagBits::e64);
+    if (result != Result::eSuccess) {
+        return;
+    }
+    const float milliseconds_per_tick = timestamp_period / 1.0e6f;
+    gStats.gpu_skinning_time = (timestamps[1] - timestamps[0]) * milliseconds_per_tick;
+    gStats.gpu_geometry_time = (timestamps[3] - timestamps[2]) * milliseconds_per_tick;
+}
+
 void Renderer::draw() {
     update_scene();
 
     device.waitForFences(1, &get_current_frame().render_fence, True, UINT64_MAX);
+    read_timestamps();
     get_current_frame().deletion_queue.flush();
     get_current_frame().descriptors.clear_pools(device);
+    // Refreshes the memory budget.
+    vmaSetCurrentFrameIndex(allocator, current_frame);
 
     auto[acquisition_result, swapchain_image_index] = device.acquireNextImageKHR(swapchain, UINT64_MAX, get_current_frame().swapchain_semaphore);
     if (acquisition_result == Result::eErrorOutOfDateKHR) {
@@ -1637,6 +1797,7 @@ void Renderer::draw() {
         .pSignalSemaphoreInfos      = &signal_info,
     };
 
+    std::unique_lock queue_lock(queue_mutex);
     graphics_queue.submit2(1, &submit, get_current_frame().render_fence);
 
     PresentInfoKHR present_info {
@@ -1650,6 +1811,7 @@ void Renderer::draw() {
     current_frame++;
 
     Result presentation_result = graphics_queue.presentKHR(present_info);
+    queue_lock.unlock();
     if (presentation_result == Result::eErrorOutOfDateKHR || presentation_result == Result::eSuboptimalKHR) {
         resize_requested = true;
     }
@@ -1658,11 +1820,8 @@ void Renderer::draw() {
 void Renderer::update_scene() {
     auto start_time = std::chrono::steady_clock::now();
 
-    draw_context.opaque_surfaces.clear();
-    draw_context.transparent_surfaces.clear();
-    draw_context.skinned_meshes.clear();
-
-    scene.root->draw(Mat4(1.0f), draw_context);
+    gTransforms.update();
+    scene.update_spatial_index();
 
     scene_data.view = scene.camera->get_component<Camera>()->get_view_matrix();
     scene_data.projection = glm::perspective(glm::radians(70.0f), (float)draw_extent.width / (float)draw_extent.height, 1000.0f, 0.1f);
@@ -1671,6 +1830,12 @@ void Renderer::update_scene() {
     scene_data.view_projection = scene_data.projection * scene_data.view;
     scene_data.inverse_projection = glm::inverse(scene_data.projection);
 
+    draw_context.opaque_surfaces.clear();
+    draw_context.transparent_surfaces.clear();
+    draw_context.skinned_meshes.clear();
+
+    scene.draw(draw_context, Frustum::from_matrix(scene_data.view_projection));
+
     scene_data.ambient_color = Vec4(1.0f, 0.6f, 0.6f, 0.1f);
     scene_data.sunlight_color = Vec4(0.5f, 0.5f, 0.5f, 0.5f);
     scene_data.sunlight_direction = Vec4(glm::normalize(Vec3(0.5, 0.5, 0.5)), 1.0f);
@@ -1752,6 +1917,14 @@ void MaterialMetallicRoughness::build_shaders(Renderer* p_renderer) {
     opaque_shader.fragment = mesh_shaders[1];
 }
 
+// Textures that are still loading are bound as a default texture, until the
+// material is written again.
+static ImageView get_texture_view(const Ref<Resource<Texture>>& p_texture, ResourceID p_fallback) {
+    const bool usable = p_texture->loaded() && (*p_texture)->image->image_view;
+    const auto& texture = usable ? p_texture : ResourceManager::get<Texture>(p_fallback);
+    return (*texture)->image->image_view;
+}
+
 MaterialInstance MaterialMetallicRoughness::write_material(Device p_device, MaterialPass p_pass, const MaterialResources& p_resources, DescriptorAllocatorGrowable& p_descriptor_allocator) {
     MaterialInstance material_data;
     material_data.pass_type = p_pass;
@@ -1765,9 +1938,9 @@ MaterialInstance MaterialMetallicRoughness::write_material(Device p_device, Mate
 
     writer.clear();
     writer.write_buffer(0, p_resources.data_buffer, sizeof(MaterialConstants), p_resources.data_buffer_offset, DescriptorType::eUniformBuffer);
-    writer.write_image(1, (*p_resources.albedo_texture)->image->image_view,          p_resources.albedo_sampler,          ImageLayout::eShaderReadOnlyOptimal, DescriptorType::eCombinedImageSampler);
-    writer.write_image(2, (*p_resources.normal_texture)->image->image_view,          p_resources.normal_sampler,          ImageLayout::eShaderReadOnlyOptimal, DescriptorType::eCombinedImageSampler);
-    writer.write_image(3, (*p_resources.metal_roughness_texture)->image->image_view, p_resources.metal_roughness_sampler, ImageLayout::eShaderReadOnlyOptimal, DescriptorType::eCombinedImageSampler);
+    writer.write_image(1, get_texture_view(p_resources.albedo_texture,          IMAGE_WHITE),          p_resources.albedo_sampler,          ImageLayout::eShaderReadOnlyOptimal, DescriptorType::eCombinedImageSampler);
+    writer.write_image(2, get_texture_view(p_resources.normal_texture,          IMAGE_DEFAULT_NORMAL), p_resources.normal_sampler,          ImageLayout::eShaderReadOnlyOptimal, DescriptorType::eCombinedImageSampler);
+    writer.write_image(3, get_texture_view(p_resources.metal_roughness_texture, IMAGE_WHITE),          p_resources.metal_roughness_sampler, ImageLayout::eShaderReadOnlyOptimal, DescriptorType::eCombinedImageSampler);
     writer.update_set(p_device, material_data.material_set);
 
     return material_data;
@@ -6,9 +6,12 @@
 #include <functional>
 #include <stddef.h>
 #include <memory>
+#include <mutex>
 #include <vk_mem_alloc.h>
 
 #include <loader.h>
+#include <core/residency.h>
+#include <core/task.h>
 #include <math.h>
 #include <rendering/types.h>
 #include <rendering/descriptors.h>
@@ -17,6 +20,10 @@
 #include <resources/texture.h>
 
 const int MAX_FRAMES_IN_FLIGHT = 4;
+// Around skinning and around the geometry pass.
+const uint32_t TIMESTAMP_COUNT = 4;
+// Mesh data is copied to the GPU through this much staging memory at a time.
+const size_t STAGING_BUFFER_SIZE = 16 * 1024 * 1024;
 
 using namespace vk;
 
@@ -46,6 +53,15 @@ struct FrameData {
     DeletionQueue deletion_queue;
     DescriptorAllocatorGrowable descriptors;
     GPUDrawPushConstants push_constants;
+    QueryPool timestamp_pool;
+    bool timestamps_written {false};
+};
+
+// Bytes to copy into a GPU buffer, see Renderer::upload_buffers.
+struct BufferUpload {
+    const void* data;
+    size_t size;
+    Buffer destination;
 };
 
 struct ComputePushConstants {
@@ -103,8 +119,12 @@ public:
     
     Queue graphics_queue;
     uint32_t graphics_queue_index;
+    // Resources are uploaded from loader threads as well, and a queue must
+    // not be used by two threads at once.
+    std::mutex queue_mutex;
     
     uint32_t current_frame {0};
+    bool memory_budget_supported {false};
     std::vector<CommandBuffer> command_buffers;
     Extent2D viewport_size;
     DeletionQueue deletion_queue;
@@ -122,6 +142,16 @@ public:
     Fence immediate_fence;
     CommandBuffer immediate_command_buffer;
     CommandPool immediate_command_pool;
+    // Guards the three above, lock before queue_mutex.
+    std::mutex immediate_mutex;
+
+    // Kept mapped for the lifetime of the renderer, see upload_buffers().
+    AllocatedBuffer staging_buffer;
+    std::mutex staging_mutex;
+
+    // Command buffers of uploads that don't block, see upload().
+    CommandPool upload_command_pool;
+    std::mutex upload_mutex;
 
     AllocatedImage image_white;
     AllocatedImage image_black;
@@ -138,6 +168,8 @@ public:
     ShaderObject skinning_shader;
 
     ktxVulkanDeviceInfo ktx_device_info;
+    // Nanoseconds per timestamp tick.
+    float timestamp_period {1.0f};
     
     bool create_vulkan_instance(uint32_t p_extension_count, const char* const* p_extensions);
     bool create_physical_device();
@@ -164,7 +196,14 @@ public:
     void transition_image(CommandBuffer p_cmd, Image p_image, ImageLayout p_current_layout, ImageLayout p_target_layout, ImageAspectFlags p_aspect_flags = ImageAspectFlagBits::eNone);
     void copy_image_to_image(CommandBuffer p_cmd, Image p_source, Image p_destination, Extent2D source_size, Extent2D destination_size);
     void immediate_submit(std::function<void(CommandBuffer p_cmd)>&& function);
+    void record_image_upload(CommandBuffer p_cmd, const AllocatedBuffer& p_source, const AllocatedImage& p_image, Extent3D p_size, bool p_mipmapped);
+
+    // Vertex data of either format. Skinned meshes get a second vertex buffer
+    // the skinning shader writes Vertex to, the others draw from the first.
+    GPUMeshBuffers upload_mesh_data(std::span<const std::byte> p_index_data, std::span<const std::byte> p_vertex_data, size_t p_vertex_count, std::span<const SkinningData> p_skinning_data, std::span<const Mat4> p_joint_matrices);
 
+    // GPU times of the frame that last used the current frame data.
+    void read_timestamps();
     void draw_skybox(CommandBuffer p_cmd, uint p_swapchain_image_index);
     void draw_geometry(CommandBuffer p_cmd);
     void draw_lighting(CommandBuffer p_cmd);
@@ -200,11 +239,27 @@ public:
     bool initialize(uint32_t p_extension_count, const char* const* p_extensions, SDL_Window* p_window, uint32_t width, uint32_t height);
     
     bool create_shader_module(const uint32_t bytes[], const int length, ShaderModule &r_shader_module);
-    GPUMeshBuffers upload_mesh(std::span<uint32_t> p_indices, std::span<Vertex> p_vertices);
-    GPUMeshBuffers upload_mesh(std::span<uint32_t> p_indices, std::span<Vertex> p_vertices, std::span<SkinningData> p_skinning_data, std::span<Mat4> p_joint_matrices);
+    // The index data holds the indices of every surface, each surface with
+    // the index type of its MeshSurface.
+    GPUMeshBuffers upload_mesh(std::span<const std::byte> p_index_data, std::span<const Vertex> p_vertices);
+    GPUMeshBuffers upload_mesh(std::span<const std::byte> p_index_data, std::span<const Vertex> p_vertices, std::span<const SkinningData> p_skinning_data, std::span<const Mat4> p_joint_matrices);
+    GPUMeshBuffers upload_mesh(std::span<const std::byte> p_index_data, std::span<const CompressedVertex> p_vertices);
+    GPUMeshBuffers upload_mesh(std::span<const std::byte> p_index_data, std::span<const CompressedVertex> p_vertices, std::span<const SkinningData> p_skinning_data, std::span<const Mat4> p_joint_matrices);
+    // Copies straight from the sources into the staging buffer and from there
+    // into the destinations, in as many submits as it takes. Blocks until
+    // the copies are done.
+    void upload_buffers(std::span<const BufferUpload> p_uploads);
     AllocatedImage create_image(Extent3D p_size, Format p_format, ImageUsageFlags p_usage, bool mipmapped = False, SampleCountFlagBits p_sample_count = SampleCountFlagBits::e1);
     AllocatedImage create_image(void* p_data, Extent3D p_size, Format p_format, ImageUsageFlags p_usage, bool mipmapped = False, SampleCountFlagBits p_sample_count = SampleCountFlagBits::e1);
+    // Like create_image, but waits for the copy without blocking. Resumes on
+    // the main thread once the image is ready to be sampled.
+    prosper::Task<AllocatedImage> create_image_async(void* p_data, Extent3D p_size, Format p_format, ImageUsageFlags p_usage, bool p_mipmapped = False);
     void generate_mipmaps(CommandBuffer p_cmd, Image p_image, Extent2D p_size);
+    // Records p_record into a command buffer of its own and submits it from
+    // any thread. Resumes on the main thread once the GPU has finished it.
+    prosper::Task<void> upload(std::function<void(CommandBuffer p_cmd)> p_record);
+    // Usage and budget of the device local heaps.
+    MemoryBudget get_gpu_memory_budget();
     void destroy_image(const AllocatedImage& p_image);
 
     void recreate_swapchain();
@@ -2,6 +2,7 @@
 
 #include <math.h>
 
+#include <cstddef>
 #include <memory>
 #include <chrono>
 #include <unordered_map>
@@ -37,6 +38,23 @@ struct Vertex {
     Vec4 tangent;
 };
 
+// Vertex of meshes imported with compressed vertices. Positions are
+// quantized to the bounds of the mesh, normals and tangents octahedral
+// encoded. Decoded in input_structures.slang.
+struct CompressedVertex {
+    uint16_t position[3];
+    // 1 where tangent.w is negative.
+    uint16_t tangent_sign;
+    // Two snorm16 each.
+    uint32_t normal;
+    uint32_t tangent;
+    // Two half floats.
+    uint32_t uv;
+    // RGBA8.
+    uint32_t color;
+};
+static_assert(sizeof(CompressedVertex) == 24);
+
 struct SkinningData {
     uint32_t joint_ids[4];
     Vec4 weights;
@@ -62,6 +80,12 @@ struct GPUDrawPushConstants {
     Mat4 model_matrix;
     Mat4 view_projection;
     DeviceAddress vertex_buffer_address;
+    // 1 if the vertices are CompressedVertex.
+    uint32_t compressed_vertices;
+    uint32_t _padding;
+    // Compressed positions decode to offset + position * scale.
+    Vec4 position_offset;
+    Vec4 position_scale;
 };
 
 struct SkinningPushConstants {
@@ -71,8 +95,17 @@ struct SkinningPushConstants {
     DeviceAddress output_vertex_buffer_address;
     DeviceAddress skinning_data_buffer_address;
     DeviceAddress joint_matrices_buffer_address;
+    // 1 if the input vertices are CompressedVertex, the output never is.
+    uint32_t compressed_vertices;
+    uint32_t _padding;
+    Vec4 position_offset;
+    Vec4 position_scale;
 };
 
+// Matches the std430 layouts of the Push structs in mesh.slang and skinning.slang.
+static_assert(offsetof(GPUDrawPushConstants, position_offset) == 144 && sizeof(GPUDrawPushConstants) == 176);
+static_assert(offsetof(SkinningPushConstants, position_offset) == 48 && sizeof(SkinningPushConstants) == 80);
+
 struct SceneLightsData {
     Mat4 view;
     Mat4 projection;
@@ -113,12 +146,18 @@ struct RenderObject {
     uint32_t index_count;
     uint32_t first_index;
     Buffer index_buffer;
+    IndexType index_type;
+    int32_t vertex_offset;
 
     MaterialInstance* material;
 
     Mat4 transform;
     DeviceAddress vertex_buffer_address;
     DeviceAddress skinned_vertex_buffer_address;
+    // Set for the draw when skinned_vertex_buffer_address has CompressedVertex.
+    bool compressed_vertices;
+    Vec4 position_offset;
+    Vec4 position_scale;
 };
 
 struct DrawContext {
@@ -133,5 +172,9 @@ struct PerformanceStats {
     uint32_t drawcall_count;
     float scene_update_time;
     float mesh_draw_time;
+    // Measured with timestamp queries, a few frames late.
+    float gpu_skinning_time;
+    float gpu_geometry_time;
+    float update_phase_times[5] {}; // Indexed by UpdatePhase
     float time_since_start {0.0f};
 };
\ No newline at end of file
@@ -0,0 +1,513 @@
+#include <resources/imported_model.h>
+
+#include <cstring>
+#include <filesystem>
+#include <format>
+
+static uint64_t align_up(uint64_t p_value, uint64_t p_alignment) {
+    return (p_value + p_alignment - 1) / p_alignment * p_alignment;
+}
+
+SamplerCreateInfo ImportedSampler::get_create_info() const {
+    return SamplerCreateInfo {
+        .magFilter = mag_filter,
+        .minFilter = min_filter,
+        .mipmapMode = mipmap_mode,
+        .addressModeU = address_mode_u,
+        .addressModeV = address_mode_v,
+        .minLod = 0,
+        .maxLod = LodClampNone,
+    };
+}
+
+
+// --- Writer ---
+
+void ImportedFileWriter::add(ImportedSection p_type, const void* p_data, size_t p_size, uint32_t p_element_size) {
+    entries.push_back(ImportedSectionEntry {
+        .type = p_type,
+        .element_size = p_element_size,
+        .offset = 0,
+        .size = p_size,
+        .checksum = ResourceID::from_bytes(p_data, p_size).value,
+    });
+    payloads.emplace_back(static_cast<const char*>(p_data), p_size);
+}
+
+ResourceID ImportedFileWriter::get_content_id() const {
+    ResourceID id = ResourceID::from_name("");
+    for (const auto& entry : entries) {
+        id = ResourceID::from_bytes(&entry.type, sizeof(entry.type), id);
+        id = ResourceID::from_bytes(&entry.checksum, sizeof(entry.checksum), id);
+    }
+    return id;
+}
+
+std::string ImportedFileWriter::to_bytes(ResourceID p_id) const {
+    const ImportedFileHeader header {
+        .magic = ImportedFileReader::MAGIC,
+        .version = ImportedFileReader::VERSION,
+        .section_count = uint32_t(entries.size()),
+        .id = p_id.value,
+    };
+    std::vector<ImportedSectionEntry> table = entries;
+    uint64_t offset = align_up(sizeof(header) + table.size() * sizeof(ImportedSectionEntry), alignment);
+    for (auto& entry : table) {
+        entry.offset = offset;
+        offset = align_up(offset + entry.size, alignment);
+    }
+
+    std::string bytes(offset, '\0');
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    std::memcpy(bytes.data() + sizeof(header), table.data(), table.size() * sizeof(ImportedSectionEntry));
+    for (size_t index = 0; index < table.size(); index++) {
+        std::memcpy(bytes.data() + table[index].offset, payloads[index].data(), payloads[index].size());
+    }
+    return bytes;
+}
+
+bool ImportedFileWriter::write(const std::string& p_path, ResourceID p_id) const {
+    const std::string bytes = to_bytes(p_id);
+    std::ofstream output(p_path, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+    output.write(bytes.data(), std::streamsize(bytes.size()));
+    return output.good();
+}
+
+
+// --- Reader ---
+
+bool ImportedFileReader::open(const std::string& p_path) {
+    path = p_path;
+    file.open(p_path, std::ifstream::in | std::ifstream::binary | std::ifstream::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    const uint64_t file_size = uint64_t(file.tellg());
+    file.seekg(0);
+    if (file_size < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) || !check_header(file_size)) {
+        return false;
+    }
+    entries.resize(header.section_count);
+    file.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(ImportedSectionEntry));
+    return bool(file) && check_entries(file_size);
+}
+
+bool ImportedFileReader::map(const std::string& p_path) {
+    path = p_path;
+    if (!mapping.open(p_path) || mapping.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, mapping.data(), sizeof(header));
+    if (!check_header(mapping.size())) {
+        return false;
+    }
+    entries.resize(header.section_count);
+    std::memcpy(entries.data(), mapping.data() + sizeof(header), entries.size() * sizeof(ImportedSectionEntry));
+    return check_entries(mapping.size());
+}
+
+bool ImportedFileReader::check_header(uint64_t p_file_size) const {
+    if (header.magic != MAGIC) {
+        return false;
+    }
+    if (header.version != VERSION) {
+        print("%s is version %u of the imported format, expected %u!", path.c_str(), header.version, VERSION);
+        return false;
+    }
+    if (sizeof(header) + uint64_t(header.section_count) * sizeof(ImportedSectionEntry) > p_file_size) {
+        print("%s is truncated!", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ImportedFileReader::check_entries(uint64_t p_file_size) const {
+    for (const auto& entry : entries) {
+        if (entry.offset > p_file_size || entry.size > p_file_size - entry.offset) {
+            print("%s is truncated!", path.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+const ImportedSectionEntry* ImportedFileReader::find(ImportedSection p_type) const {
+    for (const auto& entry : entries) {
+        if (entry.type == p_type) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool ImportedFileReader::has(ImportedSection p_type) const {
+    return find(p_type) != nullptr;
+}
+
+bool ImportedFileReader::read(ImportedSection p_type, void* r_data, size_t p_size) {
+    const ImportedSectionEntry* entry = find(p_type);
+    if (entry == nullptr || entry->size != p_size) {
+        return false;
+    }
+    if (mapping.is_open()) {
+        const char* data = get_mapped(*entry);
+        if (data != nullptr) {
+            std::memcpy(r_data, data, p_size);
+        }
+        return data != nullptr;
+    }
+    file.seekg(std::streamoff(entry->offset));
+    if (!file.read(static_cast<char*>(r_data), std::streamsize(p_size))) {
+        print("Could not read section %u of %s!", uint32_t(p_type), path.c_str());
+        return false;
+    }
+    if (ResourceID::from_bytes(r_data, p_size).value != entry->checksum) {
+        print("Checksum mismatch in section %u of %s!", uint32_t(p_type), path.c_str());
+        return false;
+    }
+    return true;
+}
+
+const char* ImportedFileReader::get_mapped(const ImportedSectionEntry& p_entry) const {
+    const char* data = mapping.data() + p_entry.offset;
+    if (ResourceID::from_bytes(data, p_entry.size).value != p_entry.checksum) {
+        print("Checksum mismatch in section %u of %s!", uint32_t(p_entry.type), path.c_str());
+        return nullptr;
+    }
+    return data;
+}
+
+
+// --- Mesh data ---
+
+std::string ImportedMeshData::to_bytes() const {
+    ImportedFileWriter writer(ImportedFileWriter::PAGE_ALIGNMENT);
+    if (compressed_vertices.empty()) {
+        writer.add(ImportedSection::VERTICES, vertices);
+    } else {
+        writer.add(ImportedSection::COMPRESSED_VERTICES, compressed_vertices);
+        writer.add(ImportedSection::VERTEX_QUANTIZATION, &quantization, sizeof(quantization), sizeof(quantization));
+    }
+    if (index_data.empty()) {
+        writer.add(ImportedSection::INDICES, indices);
+    } else {
+        writer.add(ImportedSection::INDEX_DATA, index_data);
+    }
+    writer.add(ImportedSection::SKINNING, skinning_data);
+    writer.add(ImportedSection::JOINTS, joint_data);
+    return writer.to_bytes();
+}
+
+// Counts as text lines, then the arrays.
+static bool read_legacy_mesh_data(std::istream& p_stream, ImportedMeshData& r_data) {
+    std::string line;
+    uint32_t counts[4];
+    for (uint32_t& count : counts) {
+        if (!std::getline(p_stream, line)) {
+            return false;
+        }
+        count = std::stoi(line);
+    }
+    r_data.vertices.resize(counts[0]);
+    r_data.indices.resize(counts[1]);
+    r_data.skinning_data.resize(counts[2]);
+    r_data.joint_data.resize(counts[3]);
+    p_stream.read(reinterpret_cast<char*>(r_data.vertices.data()), r_data.vertices.size() * sizeof(Vertex));
+    p_stream.read(reinterpret_cast<char*>(r_data.indices.data()), r_data.indices.size() * sizeof(uint32_t));
+    p_stream.read(reinterpret_cast<char*>(r_data.skinning_data.data()), r_data.skinning_data.size() * sizeof(SkinningData));
+    p_stream.read(reinterpret_cast<char*>(r_data.joint_data.data()), r_data.joint_data.size() * sizeof(JointData));
+    return bool(p_stream);
+}
+
+bool ImportedMeshData::read(const std::string& p_path, ImportedMeshData& r_data) {
+    ImportedFileReader reader;
+    if (reader.open(p_path)) {
+        return reader.read(ImportedSection::VERTICES, r_data.vertices)
+            && reader.read(ImportedSection::INDICES, r_data.indices)
+            && reader.read(ImportedSection::SKINNING, r_data.skinning_data)
+            && reader.read(ImportedSection::JOINTS, r_data.joint_data)
+            && reader.read(ImportedSection::INDEX_DATA, r_data.index_data)
+            && reader.read(ImportedSection::COMPRESSED_VERTICES, r_data.compressed_vertices)
+            && (!reader.has(ImportedSection::VERTEX_QUANTIZATION) || reader.read(ImportedSection::VERTEX_QUANTIZATION, &r_data.quantization, sizeof(r_data.quantization)));
+    }
+    if (reader.has_magic()) {
+        return false;
+    }
+    std::ifstream file(p_path, std::ifstream::in | std::ifstream::binary);
+    return file.is_open() && read_legacy_mesh_data(file, r_data);
+}
+
+bool ImportedMeshView::open(const std::string& p_path, ImportedMeshView& r_view) {
+    r_view = {};
+    if (r_view.reader.map(p_path)) {
+        return r_view.reader.view(ImportedSection::VERTICES, r_view.vertices)
+            && r_view.reader.view(ImportedSection::INDICES, r_view.indices)
+            && r_view.reader.view(ImportedSection::SKINNING, r_view.skinning_data)
+            && r_view.reader.view(ImportedSection::JOINTS, r_view.joint_data)
+            && r_view.reader.view(ImportedSection::INDEX_DATA, r_view.index_data)
+            && r_view.reader.view(ImportedSection::COMPRESSED_VERTICES, r_view.compressed_vertices)
+            && (!r_view.reader.has(ImportedSection::VERTEX_QUANTIZATION) || r_view.reader.read(ImportedSection::VERTEX_QUANTIZATION, &r_view.quantization, sizeof(r_view.quantization)));
+    }
+    if (r_view.reader.has_magic()) {
+        return false;
+    }
+    r_view.storage.emplace();
+    if (!ImportedMeshData::read(p_path, *r_view.storage)) {
+        return false;
+    }
+    r_view.view_storage();
+    return true;
+}
+
+ImportedMeshView ImportedMeshView::from(ImportedMeshData p_data) {
+    ImportedMeshView view;
+    view.storage = std::move(p_data);
+    view.view_storage();
+    return view;
+}
+
+void ImportedMeshView::view_storage() {
+    vertices = storage->vertices;
+    indices = storage->indices;
+    index_data = storage->index_data;
+    skinning_data = storage->skinning_data;
+    joint_data = storage->joint_data;
+    compressed_vertices = storage->compressed_vertices;
+    quantization = storage->quantization;
+}
+
+
+// --- Model ---
+
+ImportedString ImportedModel::add_string(std::string_view p_string) {
+    const ImportedString range { uint32_t(strings.size()), uint32_t(p_string.size()) };
+    strings.append(p_string);
+    return range;
+}
+
+std::string_view ImportedModel::get_string(ImportedString p_string) const {
+    if (uint64_t(p_string.offset) + p_string.length > strings.size()) {
+        return {};
+    }
+    return std::string_view(strings).substr(p_string.offset, p_string.length);
+}
+
+ImportedFileWriter ImportedModel::to_writer() const {
+    ImportedFileWriter writer;
+    writer.add(ImportedSection::STRINGS, strings.data(), strings.size());
+    writer.add(ImportedSection::SAMPLERS, samplers);
+    writer.add(ImportedSection::TEXTURES, textures);
+    writer.add(ImportedSection::MATERIALS, materials);
+    writer.add(ImportedSection::ANIMATIONS, animations);
+    writer.add(ImportedSection::ANIMATION_CHANNELS, channels);
+    writer.add(ImportedSection::POSITION_KEYS, position_keys);
+    writer.add(ImportedSection::ROTATION_KEYS, rotation_keys);
+    writer.add(ImportedSection::SURFACES, surfaces);
+    writer.add(ImportedSection::MESH_BLOB, &mesh_blob, sizeof(mesh_blob), sizeof(mesh_blob));
+    return writer;
+}
+
+bool ImportedModel::needs_import(const std::string& p_path) {
+    if (!std::filesystem::exists(p_path)) {
+        return true;
+    }
+    ImportedFileReader reader;
+    return !reader.open(p_path) && reader.has_magic() && reader.get_version() != ImportedFileReader::VERSION;
+}
+
+bool ImportedModel::read(const std::string& p_path, ImportedModel& r_model) {
+    r_model = {};
+    ImportedFileReader reader;
+    if (!reader.open(p_path)) {
+        return !reader.has_magic() && read_legacy(p_path, r_model);
+    }
+
+    r_model.mesh_id = ResourceID(reader.get_id());
+    std::vector<char> strings;
+    const bool read = reader.read(ImportedSection::STRINGS, strings)
+        && reader.read(ImportedSection::SAMPLERS, r_model.samplers)
+        && reader.read(ImportedSection::TEXTURES, r_model.textures)
+        && reader.read(ImportedSection::MATERIALS, r_model.materials)
+        && reader.read(ImportedSection::ANIMATIONS, r_model.animations)
+        && reader.read(ImportedSection::ANIMATION_CHANNELS, r_model.channels)
+        && reader.read(ImportedSection::POSITION_KEYS, r_model.position_keys)
+        && reader.read(ImportedSection::ROTATION_KEYS, r_model.rotation_keys)
+        && reader.read(ImportedSection::SURFACES, r_model.surfaces)
+        && reader.read(ImportedSection::MESH_BLOB, &r_model.mesh_blob, sizeof(r_model.mesh_blob));
+    if (!read) {
+        return false;
+    }
+    r_model.strings.assign(strings.begin(), strings.end());
+
+    // The ranges are used as is from here on.
+    for (const auto& animation : r_model.animations) {
+        if (uint64_t(animation.first_channel) + animation.channel_count > r_model.channels.size()) {
+            print("Animation channels out of range in %s!", p_path.c_str());
+            return false;
+        }
+    }
+    for (const auto& channel : r_model.channels) {
+        if (uint64_t(channel.first_position) + channel.position_count > r_model.position_keys.size()
+         || uint64_t(channel.first_rotation) + channel.rotation_count > r_model.rotation_keys.size()) {
+            print("Animation keyframes out of range in %s!", p_path.c_str());
+            return false;
+        }
+    }
+    for (const auto& surface : r_model.surfaces) {
+        if (surface.index_size != sizeof(uint16_t) && surface.index_size != sizeof(uint32_t)) {
+            print("Surface with %u byte indices in %s!", surface.index_size, p_path.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// The newline separated text of older imports. Resource ids are hashed here
+// for files imported before ids were stored.
+bool ImportedModel::read_legacy(const std::string& p_path, ImportedModel& r_model) {
+    std::ifstream file(p_path, std::ifstream::in | std::ifstream::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    print("Reading %s in the old text format, import it again to speed up loading.", p_path.c_str());
+
+    std::string line;
+    auto next_int = [&]() {
+        std::getline(file, line);
+        return std::stoi(line);
+    };
+    auto next_float = [&]() {
+        std::getline(file, line);
+        return std::stof(line);
+    };
+
+    std::getline(file, line);
+    if (line == "Mesh") {
+        std::getline(file, line);
+        ResourceID::parse(line, r_model.mesh_id);
+        std::getline(file, line);
+    } else {
+        r_model.mesh_id = ResourceID::intern(std::format("{}::/meshes/{}", p_path.c_str(), "x"));
+    }
+
+    // Samplers
+    if (line != "Samplers") {
+        return false;
+    }
+    std::vector<SamplerCreateInfo> sampler_infos(next_int());
+    file.read(reinterpret_cast<char*>(sampler_infos.data()), sampler_infos.size() * sizeof(SamplerCreateInfo));
+    for (const auto& info : sampler_infos) {
+        r_model.samplers.push_back(ImportedSampler {
+            .mag_filter = info.magFilter,
+            .min_filter = info.minFilter,
+            .mipmap_mode = info.mipmapMode,
+            .address_mode_u = info.addressModeU,
+            .address_mode_v = info.addressModeV,
+        });
+    }
+
+    // Textures, "<id> <path>" or only the path
+    std::getline(file, line);
+    if (line != "Textures") {
+        return false;
+    }
+    const int texture_count = next_int();
+    for (int texture_index = 0; texture_index < texture_count; texture_index++) {
+        std::getline(file, line);
+        ImportedTexture texture {};
+        if (line.size() > 17 && line[16] == ' ' && ResourceID::parse(std::string_view(line).substr(0, 16), texture.id)) {
+            texture.path = r_model.add_string(std::string_view(line).substr(17));
+        } else {
+            texture.id = ResourceID::intern(line);
+            texture.path = r_model.add_string(line);
+        }
+        r_model.textures.push_back(texture);
+    }
+
+    // Materials
+    std::getline(file, line);
+    if (line != "Materials") {
+        return false;
+    }
+    const int material_count = next_int();
+    for (int material_index = 0; material_index < material_count; material_index++) {
+        ImportedMaterial material {};
+        for (float& factor : material.albedo_factors) {
+            factor = next_float();
+        }
+        material.metallic = next_float();
+        material.roughness = next_float();
+        material.albedo_image = next_int();
+        material.albedo_sampler = next_int();
+        material.normal_image = next_int();
+        material.normal_sampler = next_int();
+        material.metal_roughness_image = next_int();
+        material.metal_roughness_sampler = next_int();
+        r_model.materials.push_back(material);
+    }
+
+    // Animations
+    std::getline(file, line);
+    if (line != "Animations") {
+        return false;
+    }
+    const int animation_count = next_int();
+    for (int animation_index = 0; animation_index < animation_count; animation_index++) {
+        ImportedAnimation animation {};
+        std::getline(file, line);
+        animation.name = r_model.add_string(line);
+        animation.length = next_float();
+        animation.channel_count = next_int();
+        animation.first_channel = uint32_t(r_model.channels.size());
+        for (uint32_t channel_index = 0; channel_index < animation.channel_count; channel_index++) {
+            ImportedChannel channel {};
+            channel.node_index = next_int();
+
+            channel.position_count = next_int();
+            channel.first_position = uint32_t(r_model.position_keys.size());
+            for (uint32_t key_index = 0; key_index < channel.position_count; key_index++) {
+                ImportedPositionKey key {};
+                key.time = next_float();
+                for (float& component : key.position) {
+                    component = next_float();
+                }
+                r_model.position_keys.push_back(key);
+            }
+
+            channel.rotation_count = next_int();
+            channel.first_rotation = uint32_t(r_model.rotation_keys.size());
+            for (uint32_t key_index = 0; key_index < channel.rotation_count; key_index++) {
+                ImportedRotationKey key {};
+                key.time = next_float();
+                for (float& component : key.rotation) {
+                    component = next_float();
+                }
+                r_model.rotation_keys.push_back(key);
+            }
+            r_model.channels.push_back(channel);
+        }
+        r_model.animations.push_back(animation);
+    }
+
+    // Surfaces of the first mesh, up to a blank line
+    while (std::getline(file, line) && line != "") {
+        ImportedSurface surface {};
+        surface.start_index = std::stoi(line);
+        surface.count = next_int();
+        surface.material_index = next_int();
+        surface.index_size = sizeof(uint32_t);
+        r_model.surfaces.push_back(surface);
+    }
+
+    // Vertex data, in the shared cache or inline
+    const std::streampos data_start = file.tellg();
+    std::getline(file, line);
+    if (line == "Blob") {
+        std::getline(file, line);
+        r_model.mesh_blob = r_model.add_string(line);
+        return true;
+    }
+    file.seekg(data_start);
+    r_model.inline_mesh_data.emplace();
+    return read_legacy_mesh_data(file, *r_model.inline_mesh_data);
+}
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <util.h>
+#include <core/mapped_file.h>
+#include <core/resource_id.h>
+#include <rendering/types.h>
+
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Binary container used for .imported files and the mesh blobs in the content
+// cache. A header and a table of sections come first, then the sections, each
+// aligned and checksummed, so every section is a single bounded read straight
+// into its array.
+enum class ImportedSection : uint32_t {
+    STRINGS,
+    SAMPLERS,
+    TEXTURES,
+    MATERIALS,
+    ANIMATIONS,
+    ANIMATION_CHANNELS,
+    POSITION_KEYS,
+    ROTATION_KEYS,
+    SURFACES,
+    MESH_BLOB,
+    VERTICES,
+    INDICES,
+    SKINNING,
+    JOINTS,
+    COMPRESSED_VERTICES,
+    VERTEX_QUANTIZATION,
+    INDEX_DATA,
+};
+
+struct ImportedFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t section_count;
+    uint32_t reserved { 0 };
+    // Mesh id of .imported files, unused in mesh blobs.
+    uint64_t id;
+};
+
+struct ImportedSectionEntry {
+    ImportedSection type;
+    uint32_t element_size;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t checksum;
+};
+
+// --- Section records ---
+
+struct ImportedSampler {
+    Filter mag_filter;
+    Filter min_filter;
+    SamplerMipmapMode mipmap_mode;
+    SamplerAddressMode address_mode_u;
+    SamplerAddressMode address_mode_v;
+
+    SamplerCreateInfo get_create_info() const;
+};
+
+// Range in the STRINGS section.
+struct ImportedString {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct ImportedTexture {
+    // Invalid for images that couldn't be imported.
+    ResourceID id;
+    ImportedString path;
+};
+
+struct ImportedMaterial {
+    float albedo_factors[4];
+    float metallic;
+    float roughness;
+    // -1 where the material has none.
+    int32_t albedo_image;
+    int32_t albedo_sampler;
+    int32_t normal_image;
+    int32_t normal_sampler;
+    int32_t metal_roughness_image;
+    int32_t metal_roughness_sampler;
+};
+
+struct ImportedAnimation {
+    ImportedString name;
+    float length;
+    uint32_t first_channel;
+    uint32_t channel_count;
+};
+
+struct ImportedChannel {
+    uint32_t node_index;
+    uint32_t first_position;
+    uint32_t position_count;
+    uint32_t first_rotation;
+    uint32_t rotation_count;
+};
+
+struct ImportedPositionKey {
+    float time;
+    float position[3];
+};
+
+struct ImportedRotationKey {
+    float time;
+    // x, y, z, w
+    float rotation[4];
+};
+
+struct ImportedSurface {
+    // In indices of the surface's own size, from the start of the index data.
+    uint32_t start_index;
+    uint32_t count;
+    int32_t material_index;
+    // Added to every index of the surface.
+    int32_t vertex_offset;
+    // 2 or 4 bytes.
+    uint32_t index_size;
+};
+
+// Decodes the positions of COMPRESSED_VERTICES.
+struct ImportedVertexQuantization {
+    float position_offset[3];
+    float position_scale[3];
+};
+
+struct ImportedFileWriter {
+    // Sections of mesh blobs start on a page, so they can be used in place
+    // from a memory mapping.
+    static constexpr uint64_t PAGE_ALIGNMENT = 4096;
+
+    explicit ImportedFileWriter(uint64_t p_alignment = 16) : alignment(p_alignment) {}
+
+    void add(ImportedSection p_type, const void* p_data, size_t p_size, uint32_t p_element_size = 1);
+
+    template<typename T>
+    void add(ImportedSection p_type, const std::vector<T>& p_elements) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        add(p_type, p_elements.data(), p_elements.size() * sizeof(T), sizeof(T));
+    }
+
+    // Hash of the sections, the same for files of the same content.
+    ResourceID get_content_id() const;
+
+    std::string to_bytes(ResourceID p_id = {}) const;
+    bool write(const std::string& p_path, ResourceID p_id = {}) const;
+
+private:
+    uint64_t alignment;
+    std::vector<ImportedSectionEntry> entries;
+    std::vector<std::string> payloads;
+};
+
+struct ImportedFileReader {
+    static constexpr uint32_t MAGIC = 0x504d4950; // "PIMP"
+    // 2: ImportedSurface gained vertex_offset and index_size.
+    static constexpr uint32_t VERSION = 2;
+
+    // False if the file is missing, from another version or not a container
+    // at all, like the text files of older imports.
+    bool open(const std::string& p_path);
+    // Maps the file instead of reading it, for view().
+    bool map(const std::string& p_path);
+
+    bool has(ImportedSection p_type) const;
+    uint64_t get_id() const { return header.id; }
+    uint32_t get_version() const { return header.version; }
+    // True for containers, even ones that failed to open.
+    bool has_magic() const { return header.magic == MAGIC; }
+
+    bool read(ImportedSection p_type, void* r_data, size_t p_size);
+
+    // Missing sections read as empty. False on a size or checksum mismatch.
+    template<typename T>
+    bool read(ImportedSection p_type, std::vector<T>& r_elements) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        r_elements.clear();
+        const ImportedSectionEntry* entry = find(p_type);
+        if (entry == nullptr) {
+            return true;
+        }
+        if (entry->element_size != sizeof(T) || entry->size % sizeof(T) != 0) {
+            print("Imported section %u has elements of %u bytes, expected %zu!", uint32_t(p_type), entry->element_size, sizeof(T));
+            return false;
+        }
+        r_elements.resize(entry->size / sizeof(T));
+        return read(p_type, r_elements.data(), entry->size);
+    }
+
+    // Section in place in the mapping, checked like read(). Only valid as long
+    // as the reader.
+    template<typename T>
+    bool view(ImportedSection p_type, std::span<const T>& r_elements) const {
+        static_assert(std::is_trivially_copyable_v<T>);
+        r_elements = {};
+        const ImportedSectionEntry* entry = find(p_type);
+        if (entry == nullptr) {
+            return true;
+        }
+        if (entry->element_size != sizeof(T) || entry->size % sizeof(T) != 0 || entry->offset % alignof(T) != 0) {
+            print("Imported section %u has elements of %u bytes, expected %zu!", uint32_t(p_type), entry->element_size, sizeof(T));
+            return false;
+        }
+        const char* data = get_mapped(*entry);
+        if (data == nullptr) {
+            return false;
+        }
+        r_elements = std::span<const T>(reinterpret_cast<const T*>(data), entry->size / sizeof(T));
+        return true;
+    }
+
+private:
+    std::ifstream file;
+    MappedFile mapping;
+    std::string path;
+    ImportedFileHeader header {};
+    std::vector<ImportedSectionEntry> entries;
+
+    bool check_header(uint64_t p_file_size) const;
+    bool check_entries(uint64_t p_file_size) const;
+    const ImportedSectionEntry* find(ImportedSection p_type) const;
+    const char* get_mapped(const ImportedSectionEntry& p_entry) const;
+};
+
+// Vertex data of a mesh, stored in the content cache. Meshes imported with
+// compressed vertices store those instead of vertices. Indices of older
+// imports are 32 bit and count from the first vertex of the mesh, the index
+// data of newer ones is laid out as in ImportedSurface.
+struct ImportedMeshData {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<uint8_t> index_data;
+    std::vector<SkinningData> skinning_data;
+    std::vector<JointData> joint_data;
+    std::vector<CompressedVertex> compressed_vertices;
+    ImportedVertexQuantization quantization {};
+
+    std::string to_bytes() const;
+    // Reads both containers and the count-prefixed blobs of older imports.
+    static bool read(const std::string& p_path, ImportedMeshData& r_data);
+};
+
+// Vertex data of a mesh without a copy on the heap, read in place from the
+// mapped blob. Older blobs that can't be mapped are read into storage of its
+// own.
+struct ImportedMeshView {
+    std::span<const Vertex> vertices;
+    std::span<const uint32_t> indices;
+    std::span<const uint8_t> index_data;
+    std::span<const SkinningData> skinning_data;
+    std::span<const JointData> joint_data;
+    std::span<const CompressedVertex> compressed_vertices;
+    ImportedVertexQuantization quantization {};
+
+    static bool open(const std::string& p_path, ImportedMeshView& r_view);
+    static ImportedMeshView from(ImportedMeshData p_data);
+
+private:
+    ImportedFileReader reader;
+    std::optional<ImportedMeshData> storage;
+
+    void view_storage();
+};
+
+// Everything in an .imported file except the vertex data, in the records it
+// is stored as.
+struct ImportedModel {
+    ResourceID mesh_id;
+    std::string strings;
+    std::vector<ImportedSampler> samplers;
+    std::vector<ImportedTexture> textures;
+    std::vector<ImportedMaterial> materials;
+    std::vector<ImportedAnimation> animations;
+    std::vector<ImportedChannel> channels;
+    std::vector<ImportedPositionKey> position_keys;
+    std::vector<ImportedRotationKey> rotation_keys;
+    std::vector<ImportedSurface> surfaces;
+    ImportedString mesh_blob {};
+    // Vertex data stored in the file itself, only by the oldest imports.
+    std::optional<ImportedMeshData> inline_mesh_data;
+
+    ImportedString add_string(std::string_view p_string);
+    std::string_view get_string(ImportedString p_string) const;
+
+    ImportedFileWriter to_writer() const;
+
+    // Reads the container, or the text format of older imports.
+    static bool read(const std::string& p_path, ImportedModel& r_model);
+    // True if the file is missing or a container of another version, which
+    // only importing again fixes. Other read errors are left to read().
+    static bool needs_import(const std::string& p_path);
+
+private:
+    static bool read_legacy(const std::string& p_path, ImportedModel& r_model);
+};
@@ -6,14 +6,29 @@ extern Renderer gRenderer;
 
 template<>
 void Resource<Mesh>::unload() {
-    std::println("Unloading mesh: {}", guid.c_str());
+    std::println("Unloading mesh: {}", id.get_name());
     gRenderer.destroy_buffer(pointer->mesh_buffers.index_buffer);
     gRenderer.destroy_buffer(pointer->mesh_buffers.vertex_buffer);
-    gRenderer.destroy_buffer(pointer->mesh_buffers.skinned_vertex_buffer);
+    if (pointer->mesh_buffers.skinned_vertex_buffer.buffer != VK_NULL_HANDLE) {
+        gRenderer.destroy_buffer(pointer->mesh_buffers.skinned_vertex_buffer);
+    }
     if (pointer->mesh_buffers.skinning_data_buffer.buffer != VK_NULL_HANDLE) {
         gRenderer.destroy_buffer(pointer->mesh_buffers.skinning_data_buffer);
     }
     if (pointer->mesh_buffers.joint_matrices_buffer.buffer != VK_NULL_HANDLE) {
         gRenderer.destroy_buffer(pointer->mesh_buffers.joint_matrices_buffer);
     }
-};
\ No newline at end of file
+};
+
+template<>
+size_t Resource<Mesh>::get_gpu_size() const {
+    auto get_size = [](const AllocatedBuffer& p_buffer) -> size_t {
+        return (p_buffer.buffer != VK_NULL_HANDLE) ? p_buffer.info.size : 0;
+    };
+    const GPUMeshBuffers& buffers = pointer->mesh_buffers;
+    return get_size(buffers.index_buffer)
+         + get_size(buffers.vertex_buffer)
+         + get_size(buffers.skinned_vertex_buffer)
+         + get_size(buffers.skinning_data_buffer)
+         + get_size(buffers.joint_matrices_buffer);
+}
@@ -17,14 +17,31 @@ struct GPUMeshBuffers {
 };
 
 struct MeshSurface {
+    // In indices of index_type, from the start of the index buffer.
     uint32_t start_index;
     uint32_t count;
-    Ref<MaterialInstance> material;
+    // Into MeshInstance::materials, materials belong to the model that uses
+    // the mesh, which may be cached past it. The material count for none.
+    uint32_t material_index;
+    // Indices count from this vertex.
+    int32_t vertex_offset {0};
+    IndexType index_type {IndexType::eUint32};
 };
 
 struct Mesh {
     std::string name;
     uint32_t vertex_count {0};
+    // Bounds of the vertices in model space, in the bind pose for skinned meshes.
+    AABB bounds;
+    // Vertex buffer of CompressedVertex, decoded with the offset and scale.
+    bool compressed_vertices {false};
+    Vec3 position_offset {0.0f};
+    Vec3 position_scale {1.0f};
     std::vector<MeshSurface> surfaces;
     GPUMeshBuffers mesh_buffers;
-};
\ No newline at end of file
+};
+
+template<>
+void Resource<Mesh>::unload();
+template<>
+size_t Resource<Mesh>::get_gpu_size() const;
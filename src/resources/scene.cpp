@@ -22,17 +22,17 @@ extern Renderer gRenderer; // TODO remove
 
 
 template<>
-Ref<Resource<Scene>> ResourceManager::load<Scene>(const char* p_guid) {
-    auto& resource = (*ResourceManager::get<Scene>(p_guid));
-    resource->scene_state = std::make_shared<YAML::Node>(YAML::LoadFile(p_guid));
-    resource.set_load_status(LoadStatus::LOADED);
-    return ResourceManager::get<Scene>(p_guid);
+Ref<Resource<Scene>> ResourceManager::load<Scene>(ResourceID p_id, const char* p_path) {
+    auto resource = ResourceManager::get<Scene>(p_id);
+    (*resource)->scene_state = std::make_shared<YAML::Node>(YAML::LoadFile(p_path));
+    resource->set_load_status(LoadStatus::LOADED);
+    return resource;
 }
 
 Ref<Node> Scene::instantiate() {
     if (scene_state == nullptr) {
         std::println("Error: No state");
-        return std::make_shared<Node>();
+        return Node::create();
     }
 
     return from_data(*scene_state);
@@ -3,80 +3,246 @@
 #include <rendering/types.h>
 #include <stb_image.h>
 #include <core/resource_manager.h>
+#include <loader.h>
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
 
 extern Renderer gRenderer;
 
 template<>
 void Resource<Texture>::unload() {
+    if (pointer->image == nullptr) {
+        return;
+    }
     gRenderer.destroy_image(*pointer->image);
 };
 
 template<>
-Ref<Resource<Texture>> ResourceManager::load<Texture, vk::Format>(const char* p_guid, vk::Format p_format) {
-    auto file_path = std::filesystem::path(p_guid);
-    AllocatedImage new_image {};
-    if (file_path.extension() == ".ktx2") {
-        ktxTexture2* k_texture;
-        auto result = ktxTexture2_CreateFromNamedFile(file_path.c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &k_texture);
+size_t Resource<Texture>::get_gpu_size() const {
+    return pointer->size;
+}
+
+// RGBA8 with a full mip chain.
+static size_t get_mipmapped_size(int p_width, int p_height) {
+    return size_t(p_width) * size_t(p_height) * 4 * 4 / 3;
+}
+
+// Block compressed format Basis Universal textures are transcoded to, the
+// closest to how they were encoded that the device can sample.
+static ktx_transcode_fmt_e get_transcode_format(ktxTexture2* p_texture) {
+    static const PhysicalDeviceFeatures features = gRenderer.physical_device.getFeatures();
+    const bool uastc = ktxTexture2_GetColorModel_e(p_texture) == KHR_DF_MODEL_UASTC;
+    if (uastc && features.textureCompressionASTC_LDR) {
+        return KTX_TTF_ASTC_4x4_RGBA;
+    }
+    if (!uastc && features.textureCompressionETC2) {
+        // ETC1 or ETC2 with alpha, whichever the texture needs.
+        return KTX_TTF_ETC;
+    }
+    if (features.textureCompressionBC) {
+        return KTX_TTF_BC7_RGBA;
+    }
+    if (features.textureCompressionASTC_LDR) {
+        return KTX_TTF_ASTC_4x4_RGBA;
+    }
+    if (features.textureCompressionETC2) {
+        return KTX_TTF_ETC2_RGBA;
+    }
+    return KTX_TTF_RGBA32;
+}
+
+// Transcoded textures are written like the imported ones, under a temporary
+// name first, so a load never sees a partial file.
+static void write_transcoded(ktxTexture2* p_texture, const std::string& p_path) {
+    static std::atomic<uint32_t> temporary_index { 0 };
+    const std::string temporary_path = std::format("{}.{}.tmp", p_path, temporary_index++);
+    std::error_code error;
+    std::filesystem::create_directories(CONTENT_CACHE_DIRECTORY, error);
+    if (ktxTexture_WriteToNamedFile(ktxTexture(p_texture), temporary_path.c_str()) != KTX_SUCCESS) {
+        std::filesystem::remove(temporary_path, error);
+        return;
+    }
+    std::filesystem::rename(temporary_path, p_path, error);
+    if (error) {
+        std::filesystem::remove(temporary_path, error);
+    }
+}
+
+static constexpr const char* CACHE_CHECK_KEY = "prosperCacheCheck";
+
+CacheCheck check_ktx_source(ktxTexture2* p_texture, ResourceID p_check) {
+    unsigned int length;
+    void* value;
+    if (ktxHashList_FindValue(&p_texture->kvDataHead, CACHE_CHECK_KEY, &length, &value) != KTX_SUCCESS || length != sizeof(p_check.value)) {
+        return CacheCheck::MISSING;
+    }
+    uint64_t check;
+    std::memcpy(&check, value, sizeof(check));
+    return check == p_check.value ? CacheCheck::MATCH : CacheCheck::MISMATCH;
+}
+
+void set_ktx_source(ktxTexture2* p_texture, ResourceID p_check) {
+    // Transcoded textures inherit the check of the file they came from.
+    ktxHashList_DeleteKVPair(&p_texture->kvDataHead, CACHE_CHECK_KEY);
+    ktxHashList_AddKVPair(&p_texture->kvDataHead, CACHE_CHECK_KEY, sizeof(p_check.value), &p_check.value);
+}
+
+ktxTexture2* create_ktx_texture(const void* p_data, size_t p_size) {
+    ktxTexture2* texture;
+    KTX_error_code result = ktxTexture2_CreateFromMemory((const ktx_uint8_t*) p_data, p_size, KTX_TEXTURE_CREATE_NO_FLAGS, &texture);
+    if (result != KTX_SUCCESS) {
+        print("Could not create KTX texture!");
+        return nullptr;
+    }
+    if (!ktxTexture2_NeedsTranscoding(texture)) {
+        result = ktxTexture_LoadImageData(ktxTexture(texture), nullptr, 0);
         if (result != KTX_SUCCESS) {
-            print("Could not create KTX texture!");
+            print("Could not load KTX texture!");
+            ktxTexture2_Destroy(texture);
+            return nullptr;
         }
+        return texture;
+    }
 
-        auto color_model = ktxTexture2_GetColorModel_e(k_texture);
-        ktx_transcode_fmt_e texture_format;
-        PhysicalDeviceFeatures features = gRenderer.physical_device.getFeatures();
-        if (color_model != KHR_DF_MODEL_RGBSDA) {
-            if (color_model == KHR_DF_MODEL_UASTC && features.textureCompressionASTC_LDR) {
-                texture_format = KTX_TTF_ASTC_4x4_RGBA;
-            } else if (color_model == KHR_DF_MODEL_ETC1S && features.textureCompressionETC2) {
-                texture_format = KTX_TTF_ETC;
-            } else if (features.textureCompressionASTC_LDR) {
-                texture_format = KTX_TTF_ASTC_4x4_RGBA;
-            } else if (features.textureCompressionETC2) {
-                texture_format = KTX_TTF_ETC2_RGBA;
-            } else if (features.textureCompressionBC) {
-                texture_format = KTX_TTF_BC3_RGBA;
-            } else {
-                print("Could not transcode texture!");
-            }
-            result = ktxTexture2_TranscodeBasis(k_texture, KTX_TTF_BC7_RGBA, 0);
-            if (result != KTX_SUCCESS) {
-                print("Could not transcode texture!");
-            }
+    // Transcoded once per source and format, later loads read the result.
+    const ktx_transcode_fmt_e format = get_transcode_format(texture);
+    ResourceID id = ResourceID::from_bytes(&format, sizeof(format), ResourceID::from_bytes(p_data, p_size));
+    const ResourceID check = ResourceID::from_bytes(&format, sizeof(format), ResourceID::from_bytes(p_data, p_size, CACHE_CHECK_SEED));
+    std::string path = std::format("{}/{}.ktx2", CONTENT_CACHE_DIRECTORY, id.to_string());
+    ktxTexture2* transcoded;
+    while (ktxTexture2_CreateFromNamedFile(path.c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &transcoded) == KTX_SUCCESS) {
+        const CacheCheck cached = check_ktx_source(transcoded, check);
+        if (cached == CacheCheck::MATCH && !ktxTexture2_NeedsTranscoding(transcoded)) {
+            ktxTexture2_Destroy(texture);
+            return transcoded;
         }
-        
-        ktxVulkanTexture texture;
-        result = ktxTexture2_VkUploadEx(k_texture, &gRenderer.ktx_device_info, &texture, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-        if (result != KTX_SUCCESS) {
-            print("Could not upload KTX texture!");
+        ktxTexture2_Destroy(transcoded);
+        if (cached != CacheCheck::MISMATCH) {
+            break;
+        }
+        print("Cache collision at %s", path.c_str());
+        id = ResourceID::from_bytes(&id.value, sizeof(id.value), id);
+        path = std::format("{}/{}.ktx2", CONTENT_CACHE_DIRECTORY, id.to_string());
+    }
+
+    result = ktxTexture_LoadImageData(ktxTexture(texture), nullptr, 0);
+    if (result == KTX_SUCCESS) {
+        result = ktxTexture2_TranscodeBasis(texture, format, 0);
+    }
+    if (result != KTX_SUCCESS) {
+        print("Could not transcode texture!");
+        ktxTexture2_Destroy(texture);
+        return nullptr;
+    }
+    set_ktx_source(texture, check);
+    write_transcoded(texture, path);
+    return texture;
+}
+
+// Uploads and takes ownership of p_texture, transcoded already.
+static AllocatedImage upload_ktx(ktxTexture2* p_texture, size_t& r_size) {
+    AllocatedImage new_image {};
+    KTX_error_code result;
+    r_size = 0;
+    ktxVulkanTexture texture;
+    {
+        // The KTX uploader records into the immediate command pool and
+        // waits on the queue itself.
+        std::scoped_lock lock(gRenderer.immediate_mutex, gRenderer.queue_mutex);
+        result = ktxTexture2_VkUploadEx(p_texture, &gRenderer.ktx_device_info, &texture, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+    if (result != KTX_SUCCESS) {
+        // Left without an image, materials use their fallback then.
+        print("Could not upload KTX texture: %s", ktxErrorString(result));
+        ktxTexture2_Destroy(p_texture);
+        return new_image;
+    }
+    r_size = ktxTexture_GetDataSize(ktxTexture(p_texture));
+    new_image.ktx_texture = texture;
+    new_image.image = texture.image;
+
+    ImageViewCreateInfo view_info {
+        .image      = texture.image,
+        .viewType   = static_cast<ImageViewType>(texture.viewType),
+        .format     = static_cast<Format>(texture.imageFormat),
+        .subresourceRange = ImageSubresourceRange {
+            .aspectMask     = ImageAspectFlagBits::eColor,
+            .baseMipLevel   = 0,
+            .levelCount     = texture.levelCount,
+            .baseArrayLayer = 0,
+            .layerCount     = texture.layerCount,
+        }
+    };
+    Result view_result;
+    std::tie(view_result, new_image.image_view) = gRenderer.device.createImageView(view_info);
+    ktxTexture2_Destroy(p_texture);
+    return new_image;
+}
+
+template<>
+Ref<Resource<Texture>> ResourceManager::load<Texture, vk::Format>(ResourceID p_id, const char* p_path, vk::Format p_format) {
+    auto file_path = std::filesystem::path(p_path);
+    AllocatedImage new_image {};
+    size_t size = 0;
+    if (file_path.extension() == ".ktx2") {
+        std::ifstream file(file_path, std::ifstream::in | std::ifstream::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        ktxTexture2* k_texture = create_ktx_texture(bytes.data(), bytes.size());
+        if (k_texture != nullptr) {
+            new_image = upload_ktx(k_texture, size);
         }
-        new_image.ktx_texture = texture;
-        new_image.image = texture.image;
-
-        ImageViewCreateInfo view_info {
-            .image      = texture.image,
-            .viewType   = static_cast<ImageViewType>(texture.viewType),
-            .format     = static_cast<Format>(texture.imageFormat),
-            .subresourceRange = ImageSubresourceRange {
-                .aspectMask     = ImageAspectFlagBits::eColor,
-                .baseMipLevel   = 0,
-                .levelCount     = texture.levelCount,
-                .baseArrayLayer = 0,
-                .layerCount     = texture.layerCount,
-            }
-        };
-        Result view_result;
-        std::tie(view_result, new_image.image_view) = gRenderer.device.createImageView(view_info);
-        ktxTexture2_Destroy(k_texture);
     } else {
         int w, h, nrChannels;
         unsigned char* data = stbi_load(file_path.c_str(), &w, &h, &nrChannels, 4);
-        new_image = gRenderer.create_image(data, Extent3D {uint32_t(w), uint32_t(h), 1}, p_format, ImageUsageFlagBits::eSampled, true);
+        if (data != nullptr) {
+            new_image = gRenderer.create_image(data, Extent3D {uint32_t(w), uint32_t(h), 1}, p_format, ImageUsageFlagBits::eSampled, true);
+            size = get_mipmapped_size(w, h);
+            stbi_image_free(data);
+        } else {
+            print("Could not decode %s: %s", p_path, stbi_failure_reason());
+        }
     }
     
-    auto& resource = (*ResourceManager::get<Texture>(p_guid));
-    resource->image = std::make_unique<AllocatedImage>(new_image);
-    resource.set_load_status(LoadStatus::LOADED);
+    auto resource = ResourceManager::get<Texture>(p_id);
+    (*resource)->image = std::make_unique<AllocatedImage>(new_image);
+    (*resource)->size = size;
+    resource->set_load_status(LoadStatus::LOADED);
+
+    return resource;
+}
+
+// Reads the file and decodes on the loader threads. Images decoded by stb
+// are copied without blocking a thread, KTX textures go through the KTX
+// uploader, which waits for its copy on the loader thread.
+template<>
+prosper::Task<void> ResourceManager::load_steps<Texture, vk::Format>(ResourceID p_id, std::string p_path, vk::Format p_format) {
+    std::vector<char> bytes = co_await prosper::read_file(p_path);
+    AllocatedImage new_image {};
+    size_t size = 0;
+    if (std::filesystem::path(p_path).extension() == ".ktx2") {
+        ktxTexture2* k_texture = create_ktx_texture(bytes.data(), bytes.size());
+        bytes = {};
+        if (k_texture != nullptr) {
+            new_image = upload_ktx(k_texture, size);
+        }
+    } else {
+        int w, h, nrChannels;
+        unsigned char* data = stbi_load_from_memory((const stbi_uc*) bytes.data(), int(bytes.size()), &w, &h, &nrChannels, 4);
+        bytes = {};
+        if (data != nullptr) {
+            new_image = co_await gRenderer.create_image_async(data, Extent3D {uint32_t(w), uint32_t(h), 1}, p_format, ImageUsageFlagBits::eSampled, true);
+            size = get_mipmapped_size(w, h);
+            stbi_image_free(data);
+        } else {
+            print("Could not decode %s: %s", p_path.c_str(), stbi_failure_reason());
+        }
+    }
 
-    return ResourceManager::get<Texture>(p_guid);
+    // Becomes LOADED in finish_load on the main thread. Textures that failed
+    // to load have no image, materials use their fallback then.
+    auto& resource = (*ResourceManager::get<Texture>(p_id));
+    resource->image = std::make_unique<AllocatedImage>(new_image);
+    resource->size = size;
 }
\ No newline at end of file
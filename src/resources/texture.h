@@ -1,7 +1,45 @@
 #pragma once
 
+#include <core/resource_manager.h>
+
 struct AllocatedImage;
+struct ktxTexture2;
 
 struct Texture {
     std::unique_ptr<AllocatedImage> image;
-};
\ No newline at end of file
+    // GPU memory of the image in bytes.
+    size_t size { 0 };
+};
+
+template<>
+void Resource<Texture>::unload();
+template<>
+size_t Resource<Texture>::get_gpu_size() const;
+
+// Textures the renderer creates itself.
+constexpr ResourceID IMAGE_WHITE = ResourceID::from_name("::image_white");
+constexpr ResourceID IMAGE_DEFAULT_NORMAL = ResourceID::from_name("::image_default_normal");
+
+// Cache files derived from other content, like converted and transcoded
+// textures, are named by a 64 bit hash of the source. They also record a
+// second hash of it, seeded with CACHE_CHECK_SEED, which tells apart sources
+// whose names collide.
+constexpr ResourceID CACHE_CHECK_SEED = ResourceID::from_name("::cache_check");
+
+enum class CacheCheck {
+    // Written before checks were recorded.
+    MISSING,
+    MATCH,
+    MISMATCH,
+};
+
+CacheCheck check_ktx_source(ktxTexture2* p_texture, ResourceID p_check);
+void set_ktx_source(ktxTexture2* p_texture, ResourceID p_check);
+
+// Parses KTX2 bytes. Basis Universal textures come out transcoded for the
+// device, read from the content cache if they were transcoded before. Null on
+// failure.
+ktxTexture2* create_ktx_texture(const void* p_data, size_t p_size);
+
+template<>
+prosper::Task<void> ResourceManager::load_steps<Texture, vk::Format>(ResourceID p_id, std::string p_path, vk::Format p_format);
@@ -7,12 +7,13 @@
 
 namespace State {
     struct Dodge : public State {
-        std::vector<std::function<void(std::string)>>::iterator _on_animation_finished;
+        SlotID _on_animation_finished { INVALID_SLOT };
 
         void enter() {
             anim_player->play("Roll");
-            std::function<void(std::string)> f = std::bind(&Dodge::on_animation_finished, this, std::string(""));
-            _on_animation_finished = anim_player->finished.connect(f);
+            _on_animation_finished = anim_player->finished.connect([this](std::string p_animation) {
+                on_animation_finished(p_animation);
+            });
         }
 
         void update(double delta) override;
@@ -44,7 +44,7 @@ void State::Move::update(double delta) {
     float weight = (1.0f - std::exp(-(float(delta)/0.025f)));
     actor->set_rotation(glm::slerp(actor->get_rotation(), target_rotation, weight));
 
-    Vec3 animated_velocity = actor->get_rotation() * anim_player->root_motion_velocity / float(delta);
+    Vec3 animated_velocity = actor->get_rotation() * anim_player->root_motion_velocity;
     character_controller->target_velocity.x = animated_velocity.x;
     character_controller->target_velocity.z = animated_velocity.z;   
 }